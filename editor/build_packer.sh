@@ -0,0 +1,10 @@
+#!/usr/bin/env bash
+
+# builds the host tool packing the assets into an archive, see packer/packer.cpp
+#   ./build_packer.sh && packer/packer output.c3pk res
+
+: ${CXX:=`xcrun -f clang++ 2>/dev/null || echo c++`}
+DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+cd $DIR
+
+$CXX -std=c++11 -O2 -I../src -o packer/packer packer/packer.cpp ../src/io/lz_codec.cpp
@@ -0,0 +1,202 @@
+/* cHaos3D
+ *
+ * Copyright (C) 2009-2010 reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the license in the license sub-directory.
+ *
+ */
+
+// packs a directory into an archive (see src/io/archive.h)
+//
+//  usage: packer [-s] [-a alignment] output directory
+//      -s  store only, no compression
+//      -a  the alignment of the entries, power of 2, 16 by default
+
+#include "io/archive.h"
+#include "io/lz_codec.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+    struct item {
+        std::string name;
+        std::vector<char> data;     // as it's written
+        uint32_t size;              // original
+        uint32_t codec;
+    };
+    
+    bool read_file(std::string const& path, std::vector<char>& data) {
+        FILE* fp = fopen(path.c_str(), "rb");
+        if (fp == nullptr)
+            return false;
+        
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        data.resize(size > 0 ? size : 0);
+        bool ok = size >= 0 && fread(data.data(), 1, data.size(), fp) == data.size();
+        fclose(fp);
+        return ok;
+    }
+    
+    // all the files under the dir, the names are relative with '/'
+    bool collect(std::string const& base, std::string const& sub, std::vector<item>& items) {
+        DIR* dp = opendir((base + sub).c_str());
+        if (dp == nullptr) {
+            fprintf(stderr, "unable to open the directory: %s%s\n", base.c_str(), sub.c_str());
+            return false;
+        }
+        
+        bool ok = true;
+        while (struct dirent* entry = readdir(dp)) {
+            if (entry->d_name[0] == '.')    // also the hidden ones
+                continue;
+            
+            std::string name = sub + entry->d_name;
+            struct stat st;
+            if (stat((base + name).c_str(), &st) != 0)
+                continue;
+            
+            if (S_ISDIR(st.st_mode)) {
+                ok = collect(base, name + '/', items) && ok;
+            } else if (S_ISREG(st.st_mode)) {
+                item file;
+                file.name = name;
+                if (!read_file(base + name, file.data)) {
+                    fprintf(stderr, "unable to read: %s\n", name.c_str());
+                    ok = false;
+                    continue;
+                }
+                items.emplace_back(std::move(file));
+            }
+        }
+        closedir(dp);
+        return ok;
+    }
+    
+    // keep the compressed one only if it saves enough (1/8)
+    void compress(item& file) {
+        file.size = (uint32_t)file.data.size();
+        file.codec = archive_entry::Stored;
+        if (file.data.empty())
+            return;
+        
+        std::vector<char> packed(lz::bound(file.data.size()));
+        size_t size = lz::compress(file.data.data(), file.data.size(), packed.data(), packed.size());
+        if (size > 0 && size < file.data.size() - file.data.size() / 8) {
+            packed.resize(size);
+            file.data.swap(packed);
+            file.codec = archive_entry::LZ;
+        }
+    }
+    
+    uint32_t align(uint32_t offset, uint32_t alignment) {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+    
+    bool write(char const* filename, std::vector<item> const& items, uint32_t alignment) {
+        std::vector<char> out(sizeof(archive_header));
+        std::vector<archive_entry> entries;
+        std::string names;
+        
+        for (auto& file : items) {
+            out.resize(align((uint32_t)out.size(), alignment));
+            archive_entry entry;
+            entry.name = (uint32_t)names.size();
+            entry.name_size = (uint32_t)file.name.size();
+            entry.offset = (uint32_t)out.size();
+            entry.size = file.size;
+            entry.packed_size = (uint32_t)file.data.size();
+            entry.codec = file.codec;
+            entries.push_back(entry);
+            names += file.name;
+            out.insert(out.end(), file.data.begin(), file.data.end());
+        }
+        
+        archive_header header;
+        memcpy(header.magic, "C3PK", 4);
+        header.version = archive_header::Version;
+        header.alignment = alignment;
+        header.count = (uint32_t)entries.size();
+        header.table = align((uint32_t)out.size(), alignof(archive_entry));
+        header.names = header.table + (uint32_t)(entries.size() * sizeof(archive_entry));
+        
+        out.resize(header.table);
+        out.insert(out.end(), (char const*)entries.data(), (char const*)(entries.data() + entries.size()));
+        out.insert(out.end(), names.begin(), names.end());
+        memcpy(out.data(), &header, sizeof(header));
+        
+        if (out.size() > UINT32_MAX) {
+            fprintf(stderr, "the archive is over 4GB\n");
+            return false;
+        }
+        
+        FILE* fp = fopen(filename, "wb");
+        if (fp == nullptr) {
+            fprintf(stderr, "unable to write: %s\n", filename);
+            return false;
+        }
+        bool ok = fwrite(out.data(), 1, out.size(), fp) == out.size();
+        return fclose(fp) == 0 && ok;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool store = false;
+    uint32_t alignment = archive_header::Alignment;
+    
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (strcmp(argv[arg], "-s") == 0) {
+            store = true;
+        } else if (strcmp(argv[arg], "-a") == 0 && arg + 1 < argc) {
+            alignment = (uint32_t)atoi(argv[++arg]);
+        } else {
+            break;
+        }
+    }
+    
+    if (argc - arg != 2 || alignment < 4 || (alignment & (alignment - 1)) != 0) {
+        fprintf(stderr, "usage: %s [-s] [-a alignment] output directory\n", argv[0]);
+        return 1;
+    }
+    
+    std::string base = argv[arg + 1];
+    if (base.back() != '/')
+        base += '/';
+    
+    std::vector<item> items;
+    if (!collect(base, "", items))
+        return 1;
+    
+    // the lookup is the binary search, byte order as archive::find
+    std::sort(items.begin(), items.end(), [] (item const& lhs, item const& rhs) {
+        return lhs.name < rhs.name;
+    });
+    
+    size_t total = 0, packed = 0;
+    for (auto& file : items) {
+        if (store) {
+            file.size = (uint32_t)file.data.size();
+            file.codec = archive_entry::Stored;
+        } else {
+            compress(file);
+        }
+        total += file.size;
+        packed += file.data.size();
+    }
+    
+    if (!write(argv[arg], items, alignment))
+        return 1;
+    
+    printf("%zu files, %zu -> %zu bytes\n", items.size(), total, packed);
+    return 0;
+}
@@ -1,8 +1,26 @@
 #include "action/action.h"
+#include "action/action_pool.h"
+
+void* action::operator new(size_t size) {
+    return action_pool::instance().allocate(size);
+}
+
+void action::operator delete(void* ptr, size_t size) {
+    action_pool::instance().deallocate(ptr, size);
+}
+
+namespace {
+    const uint32_t Nil = action_pool::Nil;
+    
+    // looked up every time, the table grows when the actions are
+    // created in the hooks
+    inline action_pool::slot& links(uint32_t idx) {
+        return action_pool::instance()[idx];
+    }
+}
 
 action::action()
-: _child_head(nullptr), _next_sibling(nullptr),
-_next(nullptr), _started(false)
+: _slot(action_pool::instance().acquire(this)), _started(false)
 {
 }
 
@@ -11,14 +29,15 @@ action& action::push(ptr&& act) {
         return *this;
     
     // already pushed to some action tree?
-    assert(!act->_next_sibling);
-    act->_next_sibling = std::move(_child_head);
-    _child_head = std::move(act);
+    auto idx = act.release()->_slot;
+    assert(links(idx).sibling == Nil);
+    links(idx).sibling = links(_slot).child;
+    links(_slot).child = idx;
     
     // pushing an action to a started one
     // should start it now
     if (started()) {
-        _child_head->start(); // child_head == act
+        links(idx).act->start();
     }
     return *this;
 }
@@ -32,12 +51,12 @@ void action::start() {
 }
 
 bool action::cancellable() const{
-    for (action* cur = _child_head.get();
-        cur != nullptr; cur = cur->_next_sibling.get()){
-        for (action* next = cur; next != nullptr;
-             next = next->_next.get()) {
-            if (!next->cancellable())
-                return false;
+    for (auto head : {links(_slot).child, links(_slot).parked}) {
+        for (auto cur = head; cur != Nil; cur = links(cur).sibling) {
+            for (auto next = cur; next != Nil; next = links(next).next) {
+                if (!links(next).act->cancellable())
+                    return false;
+            }
         }
     }
     return true;
@@ -56,75 +75,160 @@ void action::append(ptr&& nt){
     if (!nt)
         return;
     
-    assert(nt->_next.get() == nullptr);
-    nt->_next = std::move(_next);
-    _next = std::move(nt);
+    auto idx = nt.release()->_slot;
+    assert(links(idx).next == Nil);
+    links(idx).next = links(_slot).next;
+    links(_slot).next = idx;
 }
 
 void action::reverse() {
-    if (_next.get() != nullptr && _next->_next.get() != nullptr) {
-        ptr pre(std::move(_next));
-        ptr nt(std::move(pre->_next));
-        while (nt.get() != nullptr) {
-            ptr next(std::move(nt->_next));
-            nt->_next = std::move(pre);
-            pre = std::move(nt);
-            nt = std::move(next);
-        }
-        _next = std::move(pre);
+    auto pre = links(_slot).next;
+    if (pre == Nil || links(pre).next == Nil)
+        return;
+    
+    auto nt = links(pre).next;
+    links(pre).next = Nil;
+    while (nt != Nil) {
+        auto next = links(nt).next;
+        links(nt).next = pre;
+        pre = nt;
+        nt = next;
     }
+    links(_slot).next = pre;
 }
 
 void action::on_start() {
     _started = true;
-    for (action* child = _child_head.get();
-         child != nullptr;
-         child = child->_next_sibling.get()) {
-        child->on_start();
+    for (auto child = links(_slot).child; child != Nil;
+         child = links(child).sibling) {
+        links(child).act->on_start();
     }
 }
 
 void action::on_end() {
-    for (ptr child(std::move(_child_head));
-         child; child = std::move(child->_next_sibling)) {
-        child->on_end();
+    unpark_all();
+    auto child = links(_slot).child;
+    links(_slot).child = Nil;
+    while (child != Nil) {
+        auto* act = links(child).act;
+        auto sibling = links(child).sibling;
+        links(child).sibling = Nil;
+        
+        act->on_end();
+        delete act; // with the rest of its sequence
+        child = sibling;
     }
     _started = false;
 }
 
 void action::on_stop(bool skip) {
-    ptr child(std::move(_child_head));
-    
-    for (ptr next; child; ) {
-        next = std::move(child->_next_sibling);
-
-        child->on_stop(skip); // stop itself and all its children
+    unpark_all();
+    auto child = links(_slot).child;
+    links(_slot).child = Nil;
+    while (child != Nil) {
+        auto* act = links(child).act;
+        auto sibling = links(child).sibling;
+        links(child).sibling = Nil;
+        
+        act->on_stop(skip); // stop itself and all its children
         
         // stop the sequence
-        for (ptr link(std::move(child->_next)); link;
-             link = std::move(link->_next)){
-            link->on_stop(skip);
+        for (auto link = links(child).next; link != Nil; link = links(link).next) {
+            links(link).act->on_stop(skip);
         }
-
-        child = std::move(next);
+        
+        delete act;
+        child = sibling;
     }
 }
 
 void action::update() {
-    ptr current(std::move(_child_head));
+    // the children are updated in place; the ones pushed during the update
+    // go to the new list and wait for the next frame
+    auto children = links(_slot).child;
+    links(_slot).child = Nil;
     
-    for (ptr next; current; ) {
-        next = std::move(current->_next_sibling);
-
+    for (uint32_t prev = Nil, cur = children; cur != Nil; ) {
+        auto* current = links(cur).act;
         current->update();
+        auto sibling = links(cur).sibling;
         if (current->done()) {
             current->on_end();
-            push(std::move(current->_next));
-        } else if (!current->_next_sibling) { // if not pushed to somewhere else
-            push(std::move(current));
+            
+            // unlink it and start the next in the sequence
+            auto next = links(cur).next;
+            links(cur).sibling = links(cur).next = Nil;
+            if (prev == Nil)
+                children = sibling;
+            else
+                links(prev).sibling = sibling;
+            if (next != Nil)
+                push(ptr(links(next).act));
+            delete current;
+        } else if (current->sleeping()) {
+            // not visited again until it wakes up
+            if (prev == Nil)
+                children = sibling;
+            else
+                links(prev).sibling = sibling;
+            park(cur);
+        } else {
+            prev = cur;
         }
-        
-        current = std::move(next);
+        cur = sibling;
+    }
+    
+    // keep the running ones after the newly pushed
+    auto tail = links(_slot).child;
+    if (tail == Nil) {
+        links(_slot).child = children;
+    } else {
+        while (links(tail).sibling != Nil)
+            tail = links(tail).sibling;
+        links(tail).sibling = children;
+    }
+}
+
+void action::park(uint32_t child) {
+    auto head = links(_slot).parked;
+    auto& parked = links(child);
+    parked.sibling = head;
+    parked.prev = Nil;
+    parked.parent = _slot;
+    if (head != Nil)
+        links(head).prev = child;
+    links(_slot).parked = child;
+}
+
+void action::wake() {
+    auto& self = links(_slot);
+    auto parent = self.parent;
+    if (parent == Nil)
+        return;
+    
+    if (self.prev != Nil)
+        links(self.prev).sibling = self.sibling;
+    else
+        links(parent).parked = self.sibling;
+    if (self.sibling != Nil)
+        links(self.sibling).prev = self.prev;
+    
+    // pushed to the parent as the new ones, not started again
+    self.parent = self.prev = Nil;
+    self.sibling = links(parent).child;
+    links(parent).child = _slot;
+}
+
+void action::unpark_all() {
+    auto parked = links(_slot).parked;
+    links(_slot).parked = Nil;
+    while (parked != Nil) {
+        auto& child = links(parked);
+        auto sibling = child.sibling;
+        child.parent = child.prev = Nil;
+        child.sibling = links(_slot).child;
+        links(_slot).child = parked;
+        parked = sibling;
     }
 }
 
@@ -132,6 +236,7 @@ action::~action() {
     if (_started) {
         on_end();
     }
+    action_pool::instance().release(_slot);
 }
 
 root_action::root_action() {
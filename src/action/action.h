@@ -5,6 +5,7 @@
 #include <initializer_list>
 #include <cassert>
 #include <memory>
+#include "action/action_pool.h"
 
 /// the action, constant-updating backend
 /// it has two layors of children:
@@ -16,6 +17,9 @@
 /// on_start, on_end, on_stop: state hooks
 /// done: whether the action is done and removed
 /// cancellable: whether the action can get cancelled
+///
+/// all the actions are allocated from the action_pool, the links are
+/// the indices of their slots in the pool
 class action {
 public:
     typedef std::unique_ptr<action> ptr;
@@ -24,14 +28,23 @@ public:
     action();
     virtual ~action();
     
+    action(action const&) = delete;
+    action& operator=(action const&) = delete;
+    
+    static void* operator new(size_t);
+    static void operator delete(void*, size_t);
+    
     // add an action to its children
     // if this action is active, the added one will be
     // excuted immediately, or it will wait until the
     // parent gets triggered (action tree)
     action& push(ptr&&);
     
-    // whether it has any child
-    bool empty() const { return !_child_head; }
+    // whether it has any child, the parked ones included
+    bool empty() const {
+        auto const& links = action_pool::instance()[_slot];
+        return links.child == action_pool::Nil && links.parked == action_pool::Nil;
+    }
     
     // skip this action (go to end)
     void skip();
@@ -98,13 +111,21 @@ protected:
     virtual void on_end();
     virtual void on_stop(bool skip);
     
+    /// whether it's only waiting for an event (i.e. a timer in the wheel)
+    /// with nothing to update; it's parked out of the parent's update walk
+    /// until it wakes itself up
+    virtual bool sleeping() const { return false; }
+    
+    /// back to the parent's update walk from the next update, if parked
+    void wake();
+    
 private:
     void reverse();
     void append(ptr&&);
+    void park(uint32_t child);
+    void unpark_all();
     
-    ptr _child_head;
-    ptr _next_sibling;
-    ptr _next;
+    uint32_t _slot;     // the links in the action_pool
     bool _started;
 };
 
@@ -5,6 +5,7 @@
 #include <memory>
 #include <algorithm>
 #include <cfloat>
+#include <cmath>
 #include "Eigen/Geometry"
 
 #include "action/action.h"
@@ -43,6 +44,104 @@ struct interpolator_slerp {
     }
 };
 
+// the packing of the keys once the key frames are compressed, the keys
+// are decoded when they are sampled. keys without a codec are always kept
+// as they are
+template<class Key>
+struct keyframe_codec {
+    enum { compressible = false, words = 0 };
+};
+
+// 16-bit per component, quantized within the range of the keys
+template<>
+struct keyframe_codec<Eigen::Vector3f> {
+    typedef Eigen::Vector3f key_t;
+    enum { compressible = true, words = 3 };
+    
+    key_t min = key_t::Zero(), step = key_t::Zero();
+    
+    void prepare(key_t const* keys, size_t count) {
+        key_t lo = keys[0], hi = keys[0];
+        for (size_t i = 1; i < count; ++i) {
+            lo = lo.cwiseMin(keys[i]);
+            hi = hi.cwiseMax(keys[i]);
+        }
+        min = lo;
+        step = (hi - lo) / 65535.f;
+    }
+    
+    void encode(key_t const& key, uint16_t* out) const {
+        for (int c = 0; c < 3; ++c) {
+            float v = step[c] > 0.f ? (key[c] - min[c]) / step[c] : 0.f;
+            out[c] = static_cast<uint16_t>(std::min(std::max(v + .5f, 0.f), 65535.f));
+        }
+    }
+    
+    key_t decode(uint16_t const* in) const {
+        return min + step.cwiseProduct(key_t(in[0], in[1], in[2]));
+    }
+    
+    static key_t interpolate(key_t const& from, key_t const& to, float p) {
+        return from + (to - from) * p;
+    }
+    
+    static float error(key_t const& lhs, key_t const& rhs) {
+        return (lhs - rhs).cwiseAbs().maxCoeff();
+    }
+};
+
+// smallest three: the largest component is dropped (and made positive),
+// the other three are 15-bit each, the dropped index takes the top bits
+template<>
+struct keyframe_codec<Eigen::Quaternionf> {
+    typedef Eigen::Quaternionf key_t;
+    enum { compressible = true, words = 3 };
+    
+    void prepare(key_t const*, size_t) {}
+    
+    void encode(key_t const& key, uint16_t* out) const {
+        Eigen::Vector4f c = key.normalized().coeffs();
+        int largest = 0;
+        c.cwiseAbs().maxCoeff(&largest);
+        if (c[largest] < 0.f)
+            c = -c;
+        
+        for (int i = 0, k = 0; i < 4; ++i) {
+            if (i == largest)
+                continue;
+            float v = (c[i] * float(M_SQRT2) + 1.f) * .5f * 32767.f + .5f;
+            out[k++] = static_cast<uint16_t>(std::min(std::max(v, 0.f), 32767.f));
+        }
+        out[0] |= (largest & 2) << 14;
+        out[1] |= (largest & 1) << 15;
+    }
+    
+    key_t decode(uint16_t const* in) const {
+        int largest = ((in[0] >> 15) << 1) | (in[1] >> 15);
+        Eigen::Vector4f c;
+        float sum = 0.f;
+        for (int i = 0, k = 0; i < 4; ++i) {
+            if (i == largest)
+                continue;
+            c[i] = ((in[k++] & 0x7FFF) / 32767.f * 2.f - 1.f) / float(M_SQRT2);
+            sum += c[i] * c[i];
+        }
+        c[largest] = std::sqrt(std::max(1.f - sum, 0.f));
+        return key_t(c);
+    }
+    
+    static key_t interpolate(key_t const& from, key_t const& to, float p) {
+        return from.slerp(p, to);
+    }
+    
+    // the rotation angle between, by the chord (acos is not precise here)
+    static float error(key_t const& lhs, key_t const& rhs) {
+        float sign = lhs.coeffs().dot(rhs.coeffs()) < 0.f ? -1.f : 1.f;
+        float chord = (lhs.coeffs() - sign * rhs.coeffs()).norm();
+        return 4.f * std::asin(std::min(chord * .5f, 1.f));
+    }
+};
+
 // a collection of key frames and generic interpolation
 // action_keyframe uses this to save key frames
 // applier can use this to interpolate values
@@ -59,6 +158,21 @@ public:
     typedef std::shared_ptr<animation_keyframe> ptr;
     typedef std::shared_ptr<animation_keyframe const> const_ptr;
     
+    // compressed keys are decoded when sampled, so they are not referenced
+    typedef keyframe_codec<Key> codec_t;
+    typedef typename std::conditional<codec_t::compressible, key_t, key_t const&>::type key_ref_t;
+    
+    // the cached frame index for the playing instance, so sampling
+    // forward doesn't need to search the whole frames
+    typedef uint32_t cursor_t;
+    enum { CursorSteps = 4 }; // linear steps before a binary search
+    
+    // the two keys to interpolate and the progress between them
+    struct segment_t {
+        uint32_t from, to;
+        float progress;
+    };
+    
     // helper struct for initialize the data, TODO: remove this
     struct key_frame_t {
         typedef Key key_t;
@@ -72,9 +186,85 @@ public:
     };
     
 public:
+    // the decoded keys, empty once compressed; use key() instead
     key_frames_t const& keyframes() const {
         return _keyframes;
     }
+    
+    // number of keys
+    size_t size() const {
+        return _frame_infos.size();
+    }
+    
+    // the key at the index, decoded if compressed
+    template<class K = Key, typename std::enable_if<!keyframe_codec<K>::compressible>::type* = nullptr>
+    key_t const& key(size_t idx) const {
+        return _keyframes[idx];
+    }
+    
+    template<class K = Key, typename std::enable_if<keyframe_codec<K>::compressible>::type* = nullptr>
+    key_t key(size_t idx) const {
+        return _packed.empty() ? _keyframes[idx] : _codec.decode(&_packed[idx * codec_t::words]);
+    }
+    
+    bool compressed() const {
+        return !_packed.empty();
+    }
+    
+    // the packed keys and their codec once compressed, i.e. to be saved
+    // as they are (see skeleton_binary)
+    std::vector<uint16_t> const& packed() const { return _packed; }
+    codec_t const& codec() const { return _codec; }
+    
+    // drop the keys that the interpolation of the neighbours reproduces
+    // within the tolerance, and pack the rest (see keyframe_codec).
+    // the tolerance is in the key's unit, radians for rotations
+    template<class K = Key, typename std::enable_if<keyframe_codec<K>::compressible>::type* = nullptr>
+    void compress(float tolerance) {
+        if (compressed() || _keyframes.empty())
+            return;
+        
+        auto n = _keyframes.size();
+        frame_infos_t infos{_frame_infos.front()};
+        key_frames_t keys{_keyframes.front()};
+        for (size_t last = 0, i = 1; i + 1 < n; ++i) {
+            // i can be dropped if all keys in (last, i] are on the segment
+            // from the last kept to the next, both of which interpolate
+            auto span = _frame_infos[i + 1].offset - _frame_infos[last].offset;
+            bool drop = _frame_infos[i].type != STEP && _frame_infos[i + 1].type != STEP
+                && span > FLT_EPSILON;
+            for (size_t j = last + 1; drop && j <= i; ++j) {
+                float p = (_frame_infos[j].offset - _frame_infos[last].offset) / span;
+                drop = codec_t::error(codec_t::interpolate(_keyframes[last], _keyframes[i + 1], p),
+                                      _keyframes[j]) <= tolerance;
+            }
+            
+            if (!drop) {
+                infos.push_back(_frame_infos[i]);
+                keys.push_back(_keyframes[i]);
+                last = i;
+            }
+        }
+        if (n > 1) {
+            infos.push_back(_frame_infos.back());
+            keys.push_back(_keyframes.back());
+        }
+        
+        _codec.prepare(keys.data(), keys.size());
+        _packed.resize(keys.size() * codec_t::words);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            _codec.encode(keys[i], &_packed[i * codec_t::words]);
+        }
+        _frame_infos.swap(infos);
+        _frame_infos.shrink_to_fit();
+        key_frames_t().swap(_keyframes);
+    }
+    
+    frame_infos_t const& frame_infos() const {
+        return _frame_infos;
+    }
+    
+    int wrap() const { return _wrap; }
 
     // lower bound of the given time
     typename frame_infos_t::const_iterator keyframe(time_t offset) const {
@@ -84,6 +274,57 @@ public:
                                 });
     }
     
+    // lower bound of the given time, starting from the cursor
+    // it is amortized O(1) if the offset moves forward (playing),
+    // otherwise (seeking/looping) it falls back to the binary search
+    typename frame_infos_t::const_iterator keyframe(time_t offset, cursor_t& cursor) const {
+        auto less = [] (frame_info const& key, time_t const& offset) {
+            return key.offset < offset;
+        };
+        auto size = static_cast<cursor_t>(_frame_infos.size());
+        if (cursor > size)
+            cursor = 0;
+        
+        auto first = _frame_infos.begin(), last = _frame_infos.end();
+        if (cursor == 0 || _frame_infos[cursor - 1].offset < offset) {
+            for (int step = 0; step < CursorSteps; ++step, ++cursor) {
+                if (cursor == size || !less(_frame_infos[cursor], offset))
+                    return first + cursor;
+            }
+            first += cursor;
+        } else {
+            last = first + cursor;
+        }
+        
+        auto it = std::lower_bound(first, last, offset, less);
+        cursor = static_cast<cursor_t>(std::distance(_frame_infos.begin(), it));
+        return it;
+    }
+    
+    // the segment to interpolate at the given time, so the keys can be
+    // gathered and blended outside, i.e. the batch sampler.
+    // STEP frames hold the previous key, others interpolate; it is the same
+    // as interpolate_in_frame<I, void>
+    segment_t segment(time_t offset, cursor_t& cursor) const {
+        assert(size() > 0);
+        auto fit = keyframe(offset, cursor);
+        auto idx = static_cast<uint32_t>(std::distance(_frame_infos.begin(), fit));
+        if (fit == _frame_infos.end()) {
+            uint32_t key = _wrap == WRAP_CLAMP ? idx - 1 : 0;
+            return segment_t{key, key, 0.f};
+        } else if (idx == 0) {
+            return segment_t{0, 0, 0.f};
+        } else if (fit->type == STEP) {
+            return segment_t{idx - 1, idx - 1, 0.f};
+        } else if (fit->offset - offset <= FLT_EPSILON) {
+            return segment_t{idx, idx, 0.f};
+        }
+        
+        auto pre_ts = std::next(fit, -1);
+        return segment_t{idx - 1, idx,
+            static_cast<float>((offset - pre_ts->offset) / (fit->offset - pre_ts->offset))};
+    }
+    
     // regular interpolation
     template<class I, typename std::enable_if<!std::is_same<I, void>::value>::type* = nullptr>
     key_t interpolate(float offset, I const& i = I()) const {
@@ -93,40 +334,38 @@ public:
     template<class I, typename std::enable_if<!std::is_same<I, void>::value>::type* = nullptr>
     key_t interpolate(frame_infos_t::const_iterator const& fit, float offset, I const& i = I()) const {
         assert(offset >= 0.f && offset <= 1.f);
-        assert(_keyframes.size() > 0);
+        assert(size() > 0);
         auto& timestamp = fit;
-        auto it = _keyframes.begin() + std::distance(_frame_infos.begin(), timestamp);
-        if (it == _keyframes.end()) {
-            return _wrap == WRAP_CLAMP ? _keyframes.back() : _keyframes.front();
-        } else if (timestamp->offset - offset <= FLT_EPSILON ||
-                   it == _keyframes.begin()) {
-            return *it;
+        auto idx = static_cast<size_t>(std::distance(_frame_infos.begin(), timestamp));
+        if (timestamp == _frame_infos.end()) {
+            return _wrap == WRAP_CLAMP ? key(idx - 1) : key(0);
+        } else if (timestamp->offset - offset <= FLT_EPSILON || idx == 0) {
+            return key(idx);
         } else {
-            auto pre = std::next(it, -1);
             auto pre_ts = std::next(timestamp, -1);
-            return i(*pre, *it, (offset - pre_ts->offset) / (timestamp->offset - pre_ts->offset),
-                     (int)std::distance(_keyframes.begin(), pre));
+            return i(key(idx - 1), key(idx), (offset - pre_ts->offset) / (timestamp->offset - pre_ts->offset),
+                     (int)(idx - 1));
         }
     }
     
     // concrete/no interpolation
     template<class I, typename std::enable_if<std::is_same<I, void>::value>::type* = nullptr>
-    key_t const& interpolate(float offset) const {
+    key_ref_t interpolate(float offset) const {
         return interpolate<void>(keyframe(offset), offset);
     }
     
     template<class I, typename std::enable_if<std::is_same<I, void>::value>::type* = nullptr>
-    key_t const& interpolate(frame_infos_t::const_iterator const& fit, float offset) const {
+    key_ref_t interpolate(frame_infos_t::const_iterator const& fit, float offset) const {
         assert(offset >= 0.f && offset <= 1.f);
-        assert(_keyframes.size() > 0);
+        assert(size() > 0);
         auto& timestamp = fit;
-        auto it = _keyframes.begin() + std::distance(_frame_infos.begin(), timestamp);
-        if (it == _keyframes.end()) {
-            return _wrap == WRAP_CLAMP ? _keyframes.back() : _keyframes.front();
-        } else if (it == _keyframes.begin()) {
-            return *it;
+        auto idx = static_cast<size_t>(std::distance(_frame_infos.begin(), timestamp));
+        if (timestamp == _frame_infos.end()) {
+            return _wrap == WRAP_CLAMP ? key(idx - 1) : key(0);
+        } else if (idx == 0) {
+            return key(idx);
         } else {
-            return *std::next(it, -1);
+            return key(idx - 1);
         }
     }
 
@@ -149,11 +388,21 @@ public:
     template<class... Is>
     key_t interpolate_in_frame(float offset) const {
         assert(offset >= 0.f && offset <= 1.f);
-        assert(_keyframes.size() > 0);
+        assert(size() > 0);
         auto fit = keyframe(offset);
         assert(fit->type < sizeof...(Is));
         return interpolate_in_frame_helper<Is...>(fit, offset, fit->type);
     }
+    
+    // the same as above but using the cursor to locate the frame
+    template<class... Is>
+    key_t interpolate_in_frame(float offset, cursor_t& cursor) const {
+        assert(offset >= 0.f && offset <= 1.f);
+        assert(size() > 0);
+        auto fit = keyframe(offset, cursor);
+        assert(fit->type < sizeof...(Is));
+        return interpolate_in_frame_helper<Is...>(fit, offset, fit->type);
+    }
 
 protected:
     template<class Loader>
@@ -182,6 +431,15 @@ protected:
         normalize(dur);
     }
     
+    // the keys compressed already (the offsets normalized), codec_t::words
+    // for each of the frames
+    animation_keyframe(int wrap,
+                       frame_infos_t const& infos, std::vector<uint16_t> const& packed,
+                       codec_t const& codec)
+    : _frame_infos(infos), _wrap(wrap), _packed(packed), _codec(codec) {
+        assert(_packed.size() == _frame_infos.size() * codec_t::words);
+    }
+    
     animation_keyframe() = default;
     
     // sort the time bounds and scale it to [0,1]
@@ -234,6 +492,10 @@ private:
     key_frames_t _keyframes; // key frames are constant
     int _wrap = WRAP_CLAMP;
     
+    // packed keys once compressed, codec_t::words each
+    std::vector<uint16_t> _packed;
+    codec_t _codec;
+    
     CONSTRUCTOR_FOR_SHARED(animation_keyframe);
 };
 
@@ -0,0 +1,89 @@
+#include "action/action_pool.h"
+#include "action/action.h"
+#include <algorithm>
+#include <new>
+
+action_pool& action_pool::instance() {
+    static action_pool _instance;
+    return _instance;
+}
+
+action_pool::action_pool() {
+    std::fill(_free, _free + MaxSize / Granularity, nullptr);
+}
+
+void* action_pool::allocate(size_t size) {
+    if (size == 0 || size > MaxSize)
+        return ::operator new(size);
+    
+    auto idx = (size - 1) / Granularity;
+    ++ _used;
+    if (_free[idx] != nullptr) {
+        node* block = _free[idx];
+        _free[idx] = block->next;
+        return block;
+    }
+    
+    // the tail of the last chunk is wasted, it is small
+    size_t block_size = (idx + 1) * Granularity;
+    if (_cursor + block_size > _end) {
+        _chunks.emplace_back(new char[ChunkSize]);
+        _cursor = _chunks.back().get();
+        _end = _cursor + ChunkSize;
+    }
+    
+    void* block = _cursor;
+    _cursor += block_size;
+    return block;
+}
+
+void action_pool::deallocate(void* ptr, size_t size) {
+    if (ptr == nullptr)
+        return;
+    
+    if (size == 0 || size > MaxSize) {
+        ::operator delete(ptr);
+        return;
+    }
+    
+    auto idx = (size - 1) / Granularity;
+    node* block = static_cast<node*>(ptr);
+    block->next = _free[idx];
+    _free[idx] = block;
+    -- _used;
+}
+
+uint32_t action_pool::acquire(action* act) {
+    uint32_t idx;
+    if (!_free_slots.empty()) {
+        idx = _free_slots.back();
+        _free_slots.pop_back();
+    } else {
+        idx = static_cast<uint32_t>(_slots.size());
+        _slots.emplace_back();
+    }
+    _slots[idx] = slot{act, Nil, Nil, Nil, Nil, Nil, Nil};
+    return idx;
+}
+
+void action_pool::release(uint32_t idx) {
+    auto& released = _slots[idx];
+    for (auto linked : {released.child, released.sibling, released.next, released.parked}) {
+        if (linked != Nil)
+            _dying.push_back(linked);
+    }
+    released = slot{nullptr, Nil, Nil, Nil, Nil, Nil, Nil};
+    _free_slots.push_back(idx);
+    
+    // the outermost one destroys the whole tree
+    if (_releasing)
+        return;
+    
+    _releasing = true;
+    while (!_dying.empty()) {
+        auto* act = _slots[_dying.back()].act;
+        _dying.pop_back();
+        delete act;
+    }
+    _releasing = false;
+}
@@ -0,0 +1,82 @@
+#ifndef _CHAOS3D_ACTION_POOL_H
+#define _CHAOS3D_ACTION_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class action;
+
+/// the memory pool and the scheduler table of the actions
+///
+/// actions are small, and created/finished in bulk every frame (i.e.
+/// tweens of the ui elements), so they are carved from big chunks and the
+/// memory is recycled in free lists of the size classes, never returned to
+/// the system. the larger ones go to the global heap.
+///
+/// the structural links of the action trees (children, siblings and the
+/// sequences) are indices into one flat table of slots, the slots of the
+/// finished ones are recycled; destroying an action destroys the ones it
+/// links in a loop, not by recursion.
+/// NB: actions live on the main thread, it's not thread-safe
+class action_pool {
+public:
+    enum {
+        Granularity = 16,           // the size class step, also the alignment
+        MaxSize = 512,              // the largest size to pool
+        ChunkSize = 32 * 1024,      // memory carved each time
+    };
+    
+    enum : uint32_t { Nil = ~0u };  // no link
+    
+    /// the links of an action, it owns the linked ones
+    struct slot {
+        action* act;
+        uint32_t child;             // the first child
+        uint32_t sibling;           // the next child of the same parent
+        uint32_t next;              // the next one in the sequence
+        uint32_t parked;            // the first parked child (see action::sleeping)
+        uint32_t parent;            // only for the parked ones, to wake up
+        uint32_t prev;              // the previous parked child
+    };
+    
+public:
+    static action_pool& instance();
+    
+    void* allocate(size_t size);
+    void deallocate(void* ptr, size_t size);
+    
+    /// the slot for the new action, unlinked
+    uint32_t acquire(action*);
+    
+    /// recycle the slot of the destroyed action, the linked ones are
+    /// destroyed too
+    void release(uint32_t);
+    
+    slot& operator[](uint32_t idx) { return _slots[idx]; }
+    
+    /// the number of the pooled blocks in use
+    size_t used() const { return _used; }
+    
+private:
+    struct node {
+        node* next;
+    };
+    typedef std::unique_ptr<char[]> chunk_t;
+    
+    action_pool();
+    
+    node* _free[MaxSize / Granularity];
+    std::vector<chunk_t> _chunks;
+    char* _cursor = nullptr;
+    char* _end = nullptr;
+    size_t _used = 0;
+    
+    std::vector<slot> _slots;           // the flat table
+    std::vector<uint32_t> _free_slots;
+    std::vector<uint32_t> _dying;       // linked ones to destroy
+    bool _releasing = false;
+};
+
+#endif
@@ -1,5 +1,44 @@
 #include "action/action_timed.h"
 
+#pragma mark - action timer
+
+action_timer::~action_timer() {
+    if (_deadline != 0 && global_timer_base::has_created())
+        global_timer_base::instance().wheel().cancel(_deadline);
+}
+
+void action_timer::on_start() {
+    action::on_start();
+    _start = _timer.current_time();
+    
+    if (global_timer_base::is_global(_timer)) {
+        auto& wheel = global_timer_base::instance().wheel();
+        if (_deadline != 0)
+            wheel.cancel(_deadline);
+        _expired = false;
+        _deadline = wheel.schedule(_start + _duration, [this] () {
+            _deadline = 0;
+            _expired = true;
+            wake();
+        });
+    }
+}
+
+bool action_timer::done() const {
+    if (_expired)
+        return action::done();
+    if (_deadline != 0)
+        return false;   // waiting in the wheel
+    return _timer.current_time() - _start > _duration && action::done();
+}
+
+bool action_timer::sleeping() const {
+    // the children still need updating
+    return _deadline != 0 && action::empty();
+}
+
+#pragma mark - action timed
+
 void action_timed::update() {
     time_t off = _timer.current_time() - _start;
     auto it = _actions.begin();
@@ -6,6 +6,8 @@
 #include "common/timer.h"
 
 // action to wait for a certain amount of time/frame
+// with the global timer, the deadline is kept in its timing wheel, and
+// the waiting ones are parked out of the update walk until it fires
 class action_timer : public action {
 public:
     typedef timer::time_t time_t;
@@ -16,24 +18,23 @@ public:
     : _duration(duration), _timer(t)
     {}
 
+    virtual ~action_timer();
+
     static action::ptr wait(time_t duration) {
         return action::ptr(new action_timer(duration));
     }
 
 protected:
-    virtual void on_start() {
-        action::on_start();
-        _start = _timer.current_time();
-    };
-    
-    virtual bool done() const {
-        return _timer.current_time() - _start > _duration && action::done();
-    }
+    virtual void on_start() override;
+    virtual bool done() const override;
+    virtual bool sleeping() const override;
 
 private:
     time_t _start = 0;
     time_t _duration = 0;
     timer const& _timer;
+    timer_wheel::handle_t _deadline = 0;    // pending in the wheel
+    bool _expired = false;
 };
 
 class action_frame : public action {
@@ -1,47 +1,185 @@
 #include "action_support/action_animation.h"
 #include "sg/transform.h"
+#include <algorithm>
 
 using namespace act;
 
-action_animation::action_animation(com::animation_clip::ptr const& clip,
+action_animation::action_animation(com::animation const* anim,
+                                   timer const& timer_)
+: _timer(timer_), _animation(anim) {
+}
+
+action_animation::action_animation(clip_binding const& clip,
                                    com::animation const* anim,
                                    timer const& timer_)
-: _clip(clip), _animation(anim), _timer(timer_) {
-    _channels.resize(_animation->transforms().size(), nullptr);
-    _clip->get_channels(_animation->names(), _channels);
+: _timer(timer_), _animation(anim) {
+    play(clip);
+}
+
+action_animation::layer& action_animation::get_layer(uint32_t idx) {
+    if (idx >= _layers.size())
+        _layers.resize(idx + 1);
+    return _layers[idx];
+}
+
+void action_animation::play(clip_binding const& clip, uint32_t idx, time_t fade) {
+    auto& layer = get_layer(idx);
+    auto now = _timer.current_time();
+    
+    // the playing ones fade out from where they are
+    if (fade <= 0.f) {
+        layer.tracks.clear();
+    } else {
+        for (auto& it : layer.tracks) {
+            it.from = it.weight;
+            it.to = 0.f;
+            it.fade_start = now;
+            it.fade = fade;
+        }
+    }
+    
+    layer.tracks.emplace_back();
+    auto& track = layer.tracks.back();
+    track.binding = &clip;
+    track.cursors.resize(clip.channels.size());
+    track.start = now;
+    if (fade > 0.f) {
+        track.from = track.weight = 0.f;
+        track.fade_start = now;
+        track.fade = fade;
+    }
+}
+
+void action_animation::set_layer_weight(uint32_t idx, float weight) {
+    get_layer(idx).weight = weight;
+}
+
+void action_animation::set_layer_mask(uint32_t idx, mask_t const& mask) {
+    get_layer(idx).mask = mask;
+}
+
+com::animation_clip const* action_animation::plain_clip() const {
+    if (_layers.size() != 1)
+        return nullptr;
+    
+    auto const& layer = _layers.front();
+    if (layer.tracks.size() != 1 || layer.weight < 1.f || !layer.mask.empty())
+        return nullptr;
+    
+    auto const& track = layer.tracks.front();
+    return track.fade <= 0.f && track.weight >= 1.f ? track.binding->clip.get() : nullptr;
+}
+
+action_animation::time_t action_animation::offset(track const& track) const {
+    auto elapsed = _timer.current_time() - track.start;
+    return fmod(elapsed, _loop) / _loop;
+}
+
+void action_animation::update_weights() {
+    auto now = _timer.current_time();
+    for (auto& layer : _layers) {
+        for (auto& it : layer.tracks) {
+            if (it.fade > 0.f) {
+                float t = std::min<float>((now - it.fade_start) / it.fade, 1.f);
+                it.weight = it.from + (it.to - it.from) * t;
+                if (t >= 1.f)
+                    it.fade = 0.f;
+            }
+            it.at = offset(it);
+        }
+        
+        // the last one is kept, even faded out
+        if (layer.tracks.size() > 1) {
+            layer.tracks.erase(std::remove_if(layer.tracks.begin(), layer.tracks.end() - 1,
+                                              [] (track const& it) {
+                                                  return it.fade <= 0.f && it.weight <= 0.f;
+                                              }),
+                               layer.tracks.end() - 1);
+        }
+    }
 }
 
 void action_animation::update() {
     typedef interpolator_linear<vector3f> linear_t;
-    typedef interpolator_linear<float> linearf_t;
     typedef interpolator_slerp<quaternionf> slerp_t;
     action::update();
-
-    auto elapsed = _timer.current_time() - _start;
-    auto normalized = fmod(elapsed, _loop) / _loop;
+    update_weights();
     
-    auto setup_it = _animation->setup_poses().begin();
-    auto go_it = _animation->transforms().begin();
-    auto channel_it = _channels.begin();
-    for (; channel_it != _channels.end(); ++go_it, ++channel_it, ++setup_it) {
-        if (*channel_it == nullptr)
-            continue;
+    auto const& setups = _animation->setup_poses();
+    auto const& transforms = _animation->transforms();
+    for (size_t joint = 0; joint < transforms.size(); ++joint) {
+        auto const& setup = setups[joint];
+        vector3f translate = setup.translate, scale = setup.scale;
+        quaternionf rotate = setup.rotate;
+        bool posed = false;
         
-        if ((*channel_it)->rotate) {
-            (*go_it)->set_rotate(setup_it->rotate
-                                 * (*channel_it)->rotate->interpolate_in_frame<slerp_t, void>(normalized));
-        }
-        if ((*channel_it)->translate) {
-            (*go_it)->set_translate(setup_it->translate +
-                                    (*channel_it)->translate->interpolate_in_frame<linear_t, void>(normalized));
-        }
-        if ((*channel_it)->scale) {
-            // TODO/FIXME
-            //(*go_it)->set_scale(//setup_it->scale +
-            //                    (*channel_it)->scale->interpolate<linear_t>(normalized));
+        for (auto& layer : _layers) {
+            float weight = layer.weight;
+            if (!layer.mask.empty())
+                weight *= joint < layer.mask.size() ? layer.mask[joint] : 0.f;
+            if (weight <= 0.f)
+                continue;
+            
+            // the weighted sum of the tracks, relative to the setup pose;
+            // the tracks without the channel stay in the setup pose
+            vector3f sum_t = vector3f::Zero(), sum_s = vector3f::Zero();
+            quaternionf::Coefficients sum_r = quaternionf::Coefficients::Zero();
+            float total = 0.f;
+            bool sampled = false;
+            for (auto& it : layer.tracks) {
+                if (it.weight <= 0.f)
+                    continue;
+                
+                auto* channel = it.binding->channels[joint];
+                auto& cursor = it.cursors[joint];
+                vector3f t = vector3f::Zero(), s = vector3f::Ones();
+                quaternionf r = quaternionf::Identity();
+                if (channel != nullptr) {
+                    if (channel->translate)
+                        t = channel->translate->interpolate_in_frame<linear_t, void>(it.at, cursor.translate);
+                    if (channel->scale)
+                        s = channel->scale->interpolate_in_frame<linear_t, void>(it.at, cursor.scale);
+                    if (channel->rotate)
+                        r = channel->rotate->interpolate_in_frame<slerp_t, void>(it.at, cursor.rotate);
+                    sampled = true;
+                }
+                
+                sum_t += it.weight * t;
+                sum_s += it.weight * s;
+                // keep the rotations in the same hemisphere
+                sum_r += (sum_r.dot(r.coeffs()) < 0.f ? -it.weight : it.weight) * r.coeffs();
+                total += it.weight;
+            }
+            
+            if (!sampled)
+                continue;
+            
+            // fading in over nothing blends with the layers below
+            weight *= std::min(total, 1.f);
+            quaternionf r;
+            r.coeffs() = sum_r.normalized();
+            vector3f t = setup.translate + sum_t / total;
+            vector3f s = setup.scale.cwiseProduct(sum_s / total);
+            
+            if (weight >= 1.f) {
+                translate = t;
+                scale = s;
+                rotate = setup.rotate * r;
+            } else {
+                translate += (t - translate) * weight;
+                scale += (s - scale) * weight;
+                rotate = rotate.slerp(weight, setup.rotate * r);
+            }
+            posed = true;
         }
         
-        (*go_it)->mark_dirty();
+        if (!posed)
+            continue;
+        
+        transforms[joint]->set_translate(translate);
+        transforms[joint]->set_rotate(rotate);
+        transforms[joint]->set_scale(scale);
+        transforms[joint]->mark_dirty();
         
         // TODO: more channels and more types of interpolation
     }
@@ -52,6 +190,12 @@ bool action_animation::done() const {
 }
 
 void action_animation::on_start() {
-    _start = _timer.current_time();
+    auto now = _timer.current_time();
+    for (auto& layer : _layers) {
+        for (auto& it : layer.tracks) {
+            it.start = now;
+            it.fade_start = now;
+        }
+    }
     return action::on_start();
-}
\ No newline at end of file
+}
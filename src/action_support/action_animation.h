@@ -6,36 +6,112 @@
 #include "com/anim/animation.h"
 #include <memory>
 
+namespace com {
+    class clip_sampler;
+}
+
 namespace act {
-    
+
     /// action for animation component
     /// it is similar to the animation controller, to manage the internal
     /// state, calculate/blend animations and apply to the scene node
+    ///
+    /// the clips play in layers: the clips in the same layer cross fade
+    /// from one to the next, and the upper layers override the lower ones
+    /// by the layer weight, masked per joint. all of them are blended in
+    /// one pass over the joints, each transform is written once.
     class action_animation : public action {
     public:
         typedef com::animation_clip::clip_channel clip_channel;
         typedef std::vector<clip_channel*> channels_t;
         typedef timer::time_t time_t;
-        
+
+        // the sampling positions for each channel of this instance
+        struct channel_cursor {
+            com::animation_clip::translate_channel_t::cursor_t translate = 0;
+            com::animation_clip::scale_channel_t::cursor_t scale = 0;
+            com::animation_clip::rotate_channel_t::cursor_t rotate = 0;
+        };
+        typedef std::vector<channel_cursor> cursors_t;
+
+        // per joint weights of a layer, empty for all joints fully
+        typedef std::vector<float> mask_t;
+
+        typedef com::skeleton::clip_binding clip_binding;
+
+        /// one clip playing in a layer
+        struct track {
+            clip_binding const* binding = nullptr; // shared clip/joint mapping
+            cursors_t cursors;
+            time_t start = 0.f;                  // start time
+            time_t fade_start = 0.f;             // start time of the fading
+            time_t fade = 0.f;                   // fading duration, 0 for none
+            float from = 1.f, to = 1.f;          // the fading weights
+            float weight = 1.f;                  // the current weight
+            time_t at = 0.f;                     // the normalized time to sample
+        };
+        typedef std::vector<track> tracks_t;
+
+        struct layer {
+            tracks_t tracks;    // the last one is the target of the fading
+            mask_t mask;
+            float weight = 1.f;
+        };
+        typedef std::vector<layer> layers_t;
+
     public:
-        action_animation(com::animation_clip::ptr const&,
+        /// an empty controller, the clips are played later
+        action_animation(com::animation const*,
+                         timer const& = global_timer_base::instance());
+
+        /// play the clip in the base layer
+        action_animation(clip_binding const&,
                          com::animation const*, // FIXME: memory manager
                          timer const& = global_timer_base::instance());
-        
+
         virtual bool done() const override;
-        
+
+        /// play the clip in the layer, fading in during the given time while
+        /// the other clips in the layer fade out. 0 to switch immediately
+        void play(clip_binding const&, uint32_t layer = 0, time_t fade = 0.f);
+
+        /// the weight of the layer over the ones below
+        void set_layer_weight(uint32_t layer, float weight);
+
+        /// the per joint weights of the layer (joint index order)
+        void set_layer_mask(uint32_t layer, mask_t const& mask);
+
+        /// the only clip playing without any blending, that can be sampled
+        /// in a batch, or nullptr
+        com::animation_clip const* plain_clip() const;
+
+        /// the playing clip (the base one)
+        com::animation_clip const& clip() const { return *base().binding->clip; }
+
+        /// the normalized time to sample the clip (the base one)
+        time_t offset() const { return offset(base()); }
+
     protected:
         virtual void update() override;
         virtual void on_start() override;
-        
+
     private:
+        track const& base() const { return _layers.front().tracks.back(); }
+        track& base() { return _layers.front().tracks.back(); }
+        layer& get_layer(uint32_t);
+
+        time_t offset(track const&) const;
+
+        /// advance the fading, drop the tracks faded out
+        void update_weights();
+
         timer const& _timer;
-        time_t _start;          // start time
         time_t _duration;       // the entire duration
         time_t _loop = 1.f;     // the duration for each piece
-        com::animation_clip::ptr _clip;    // only one animation for now
         com::animation const* _animation;                 // FIXME: temp solution
-        channels_t _channels;
+        layers_t _layers;
+
+        friend class com::clip_sampler;
     };
 }
 #endif
@@ -35,6 +35,10 @@ public:
     /// get all the loader
     loaders_t const& loaders() const { return _loaders; }
 
+    /// the fresh handles of the assets changed since the last call, to
+    /// reload in place (see asset_collection::reload), none by default
+    virtual handles_t changes() { return handles_t(); }
+
 private:
     loaders_t const _loaders;
 };
@@ -1,20 +1,63 @@
 #include "asset/asset_collection.h"
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
 
 asset_collection::asset_collection(context const& ctx) : _context(ctx) {
 
 }
 
 asset_collection::~asset_collection() {
-    // TODO:
-    // To signal the loading thread to stop
+    // stop the workers before the handles are gone
+    _workers.reset();
 }
 
-void asset_collection::purge() {
-    for (auto& it: _assets) {
-        if (it.second->is_loaded() && it.second->unique()) {
-            it.second->unload();
+asset_collection::budget_t asset_collection::usage() const {
+    budget_t usage = {0, 0};
+    std::unordered_set<asset_handle*> counted;
+    for (auto& it : _assets) {
+        if (it.second->is_loaded() && counted.insert(it.second.get()).second) {
+            auto cost = it.second->cost();
+            usage.cpu += cost.cpu, usage.gpu += cost.gpu;
         }
     }
+    return usage;
+}
+
+size_t asset_collection::purge() {
+    // the same handle can be under different names
+    std::vector<asset_handle*> unused;
+    std::unordered_set<asset_handle*> visited;
+    budget_t usage = {0, 0};
+    for (auto& it : _assets) {
+        auto* handle = it.second.get();
+        if (!handle->is_loaded() || !visited.insert(handle).second)
+            continue;
+
+        auto cost = handle->cost();
+        usage.cpu += cost.cpu, usage.gpu += cost.gpu;
+        if (handle->unique() && !pending(handle))
+            unused.push_back(handle);
+    }
+
+    std::sort(unused.begin(), unused.end(), [] (asset_handle* lhs, asset_handle* rhs) {
+        return lhs->last_used() < rhs->last_used();
+    });
+
+    size_t purged = 0;
+    for (auto* handle : unused) {
+        if (usage.cpu <= _budget.cpu && usage.gpu <= _budget.gpu)
+            break;
+
+        auto cost = handle->cost();
+        usage.cpu -= std::min(usage.cpu, cost.cpu);
+        usage.gpu -= std::min(usage.gpu, cost.gpu);
+        handle->unload();
+        ++ purged;
+    }
+
+    LOG_INFO("purged assets: " << purged << " (" << usage.cpu << ',' << usage.gpu << ")");
+    return purged;
 }
 
 asset_handle::ptr asset_collection::load(std::string const& name) {
@@ -25,7 +68,19 @@ asset_handle::ptr asset_collection::load(std::string const& name) {
         return nullptr;
     }
 
+    // the pending one is finished first, not to race with the workers
+    auto pending = _requests.find(it->second.get());
+    if (pending != _requests.end()) {
+        LOG_INFO("finish loading asset: " << name);
+        auto request = pending->second;
+        wait(request);
+    }
+
+    touch(it->second.get());
     if (!it->second->is_loaded()) {
+        for (auto& dependency : it->second->dependencies())
+            load(dependency);
+
         LOG_INFO("start loading asset: " << name);
         do_load(it->second.get());
     } else {
@@ -35,12 +90,214 @@ asset_handle::ptr asset_collection::load(std::string const& name) {
     return it->second;
 }
 
+asset_request::ptr asset_collection::load_async(std::string const& name, int priority) {
+    auto it = _assets.find(name);
+    if (it == _assets.end()) {
+        LOG_WARN("unable to load the asset (" << name
+                 << ") not found");
+        return nullptr;
+    }
+
+    auto pending = _requests.find(it->second.get());
+    if (pending != _requests.end() && pending->second->revive())
+        return pending->second;
+
+    if (!_workers)
+        _workers.reset(new asset_workers());
+
+    touch(it->second.get());
+    if (it->second->is_loaded()) {
+        auto request = std::make_shared<asset_request>(it->second, priority, 0);
+        request->set_loaded();
+        return request;
+    }
+
+    LOG_INFO("queue loading asset: " << name);
+    auto request = _workers->push(it->second, priority);
+    _requests[it->second.get()] = request;
+    return request;
+}
+
+asset_handle::ptr asset_collection::wait(asset_request::ptr const& request) {
+    assert(request);
+    if (request->state() != asset_request::Loaded) {
+        for (auto& dependency : request->handle()->dependencies()) {
+            auto it = _assets.find(dependency);
+            auto pending = it != _assets.end() ? _requests.find(it->second.get()) : _requests.end();
+            if (pending != _requests.end()) {
+                auto waiting = pending->second;
+                wait(waiting);
+            }
+        }
+
+        assert(_workers);
+        _workers->wait(*request);
+        finish(*request);
+    }
+    return request->ready() ? request->handle() : nullptr;
+}
+
+size_t asset_collection::update(size_t max_loads) {
+    ++ _frame;
+    if (!_workers)
+        return 0;
+
+    auto finished = _workers->take_finished();
+    _finished.insert(_finished.end(), finished.begin(), finished.end());
+
+    // the uploads are spread over the frames by the max, the ones waiting
+    // for the dependencies stay
+    size_t loaded = 0;
+    std::vector<asset_request::ptr> waiting;
+    for (auto& request : _finished) {
+        bool prepared = request->state() == asset_request::Prepared;
+        if (prepared && (loaded >= max_loads || !dependencies_loaded(*request->handle()))) {
+            waiting.push_back(request);
+            continue;
+        }
+
+        if (prepared)
+            ++ loaded;
+        finish(*request);
+    }
+    _finished.swap(waiting);
+    return loaded;
+}
+
+bool asset_collection::dependencies_loaded(asset_handle const& handle) const {
+    for (auto& dependency : handle.dependencies()) {
+        auto it = _assets.find(dependency);
+        if (it != _assets.end() && pending(it->second.get()))
+            return false;
+    }
+    return true;
+}
+
+asset_request* asset_collection::pending(asset_handle* handle) const {
+    // the cancelled ones are dropped once the workers hand them back
+    auto it = _requests.find(handle);
+    if (it == _requests.end() || it->second->state() == asset_request::Cancelled)
+        return nullptr;
+    return it->second.get();
+}
+
+bool asset_collection::depends_on(std::string const& name, std::string const& dependency) const {
+    if (name == dependency)
+        return true;
+
+    auto it = _assets.find(name);
+    if (it == _assets.end())
+        return false;
+    for (auto& next : it->second->dependencies()) {
+        if (depends_on(next, dependency))
+            return true;
+    }
+    return false;
+}
+
+bool asset_collection::add_dependency(std::string const& name, std::string const& dependency) {
+    auto it = _assets.find(name);
+    if (it == _assets.end() || _assets.find(dependency) == _assets.end()) {
+        LOG_WARN("unable to add the dependency (" << name << " -> " << dependency << ") not found");
+        return false;
+    }
+
+    if (depends_on(dependency, name)) {
+        LOG_WARN("unable to add the dependency (" << name << " -> " << dependency << ") a cycle");
+        return false;
+    }
+
+    auto& dependencies = it->second->_dependencies;
+    if (std::find(dependencies.begin(), dependencies.end(), dependency) == dependencies.end())
+        dependencies.push_back(dependency);
+    return true;
+}
+
+asset_preload::ptr asset_collection::preload(std::vector<std::string> const& names, int priority) {
+    // the post order of the graph (the dependencies first) with the height,
+    // the longest chain of the dependencies below
+    std::unordered_map<std::string, int> heights;
+    std::vector<std::string> order;
+    std::function<int (std::string const&)> visit = [&] (std::string const& name) {
+        auto visited = heights.find(name);
+        if (visited != heights.end())
+            return visited->second;
+
+        auto it = _assets.find(name);
+        if (it == _assets.end()) {
+            LOG_WARN("unable to preload the asset (" << name << ") not found");
+            return heights[name] = -1;
+        }
+
+        int height = 0;
+        for (auto& dependency : it->second->dependencies())
+            height = std::max(height, visit(dependency) + 1);
+        order.push_back(name);
+        return heights[name] = height;
+    };
+
+    for (auto& name : names)
+        visit(name);
+
+    // the deeper ones are prepared first
+    asset_preload::ptr preload(new asset_preload());
+    for (auto& name : order) {
+        auto request = load_async(name, priority - heights[name]);
+        if (request)
+            preload->_requests.push_back(request);
+    }
+    LOG_INFO("preload assets: " << preload->total());
+    return preload;
+}
+
+void asset_collection::finish(asset_request& request) {
+    auto it = _requests.find(request.handle().get());
+    if (it != _requests.end() && it->second.get() == &request)
+        _requests.erase(it);
+
+    // cancelled, or loaded by waiting
+    if (request.state() != asset_request::Prepared)
+        return;
+
+    touch(request.handle().get());
+    do_load(request.handle().get());
+    request.set_loaded();
+}
+
 void asset_collection::do_load(asset_handle* handle) {
     assert(handle != nullptr);
 
     handle->load(*this);
 }
 
+size_t asset_collection::reload(handles_t const& fresh) {
+    size_t reloaded = 0;
+    for (auto& it : fresh) {
+        auto existed = _assets.find(it.first);
+        if (existed == _assets.end()) {
+            add(it.first, it.second);
+            continue;
+        } else if (existed->second == it.second) {
+            continue;
+        }
+
+        // not to race with the workers preparing the old source
+        auto* handle = existed->second.get();
+        auto pending = _requests.find(handle);
+        if (pending != _requests.end()) {
+            auto request = pending->second;
+            wait(request);
+        }
+
+        LOG_INFO("reload asset: " << it.first);
+        if (handle->reload(*it.second, *this))
+            ++ reloaded;
+        else
+            LOG_WARN("unable to reload the asset: " << it.first);
+    }
+    return reloaded;
+}
+
 bool asset_collection::add(std::string const& name, handle_ptr const& handle, bool override) {
     handles_t::iterator it;
     if (!override || (it = _assets.find(name)) == _assets.end()) {
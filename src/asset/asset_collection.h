@@ -3,17 +3,20 @@
 
 #include "common/log.h"
 #include "asset/asset_handle.h"
+#include "asset/asset_request.h"
 
 #include <memory>
 #include <string>
-#include <thread>
+#include <cstdint>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 class asset_collection {
 public:
     typedef asset_handle::ptr handle_ptr;
     typedef std::unordered_map<std::string, handle_ptr> handles_t;
+    typedef std::unordered_map<asset_handle*, asset_request::ptr> requests_t;
 
     /// the asset context to decide which subset of assets should be loaded
     /// i.e.
@@ -23,6 +26,8 @@ public:
         float scale; /// scaling factor
     };
 
+    typedef asset_handle::cost_t budget_t;
+
 public:
     /// the collection containing the assets based on the context
     asset_collection(context const&);
@@ -46,6 +51,31 @@ public:
             return handle->as<asset_handle_base<T>>().get_asset();
     }
 
+    /// load the asset asynchronously by the priority (higher first), it's
+    /// loaded in the update of the main thread once the workers prepare
+    /// it; the same request for the handle is returned if it's pending.
+    /// return null if the meta doesn't exist
+    asset_request::ptr load_async(std::string const& name, int priority = 0);
+
+    /// finish the request right away, blocking, the pending dependencies
+    /// are finished first
+    asset_handle::ptr wait(asset_request::ptr const&);
+
+    /// declare the asset needs the other one loaded first, i.e. an atlas
+    /// needs its texture; false if either doesn't exist or it'd be a cycle.
+    /// the bundles declare theirs in a manifest (see locator_asset_bundle)
+    bool add_dependency(std::string const& name, std::string const& dependency);
+
+    /// load the assets with all their dependencies asynchronously, they're
+    /// all prepared in parallel, the dependencies by the higher priority,
+    /// and loaded in the topological order (see update)
+    asset_preload::ptr preload(std::vector<std::string> const& names, int priority = 0);
+
+    /// load the prepared ones on the main thread (i.e. GPU upload), up to
+    /// the given number, to be called every frame; the ones with pending
+    /// dependencies wait for the next frames; returns the loaded
+    size_t update(size_t max_loads = SIZE_MAX);
+
     /// check if the given name is contained in this collection
     bool contains(std::string const& name) {
         return _assets.find(name) != _assets.end();
@@ -54,9 +84,22 @@ public:
     /// manually add a new asset meta
     bool add(std::string const& name, handle_ptr const& handle, bool override = true);
 
-    /// release unused resources
-    // TODO: LRU, space to free, other hints for partial purge?
-    void purge();
+    /// reload the existing ones in place from the fresh handles (see
+    /// locator_asset_bundle::changes), the handles are kept so the
+    /// dependents see the new data; the new names are added; returns
+    /// the number reloaded
+    size_t reload(handles_t const& fresh);
+
+    /// the memory budgets for the purge, zero by default (all unused)
+    void set_budget(size_t cpu, size_t gpu) { _budget = {cpu, gpu}; }
+    budget_t const& budget() const { return _budget; }
+
+    /// the memory held by the loaded assets
+    budget_t usage() const;
+
+    /// release the unused resources, the least recently used first,
+    /// until it's within the budgets; returns the number released
+    size_t purge();
 
     /// get the context
     context const& context_() const { return _context; };
@@ -66,12 +109,22 @@ public:
 
 private:
     void do_load(asset_handle*);
-    //void loading_thread();
+    void finish(asset_request&);
+    void touch(asset_handle* handle) { handle->_last_used = _frame; }
+    bool depends_on(std::string const& name, std::string const& dependency) const;
+    bool dependencies_loaded(asset_handle const&) const;
+    asset_request* pending(asset_handle*) const; // not cancelled, or null
 
 protected: // subclassing
     context const _context;
     handles_t _assets;
-    //std::thread _loading_thread; // TODO: asynch loading
+
+private:
+    requests_t _requests;                   // the pending ones
+    std::vector<asset_request::ptr> _finished; // to load in the update
+    std::unique_ptr<asset_workers> _workers; // created on the first async load
+    budget_t _budget = {0, 0};
+    uint32_t _frame = 0;                    // counted by the update
 };
 
 #endif
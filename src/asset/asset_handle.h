@@ -1,8 +1,13 @@
 #ifndef _CHAOS3D_ASSET_ASSET_HANDLE_H
 #define _CHAOS3D_ASSET_ASSET_HANDLE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 class referenced_count;
 class asset_collection;
@@ -16,6 +21,11 @@ class asset_collection;
 class asset_handle : public std::enable_shared_from_this<asset_handle> {
 public:
     typedef std::shared_ptr<asset_handle> ptr;
+
+    /// the memory held by the loaded asset in bytes
+    struct cost_t {
+        size_t cpu, gpu;
+    };
     
 public:
     // helper function to downcast
@@ -24,13 +34,23 @@ public:
         return static_cast<typename std::remove_cv<T>::type&>(*this);
     }
 
-    // TODO: thread-safe for async loading
+    /// main thread only, the workers only prepare (see asset_request)
     virtual bool is_loaded() const = 0;
     
     /// check if there is no other references to the actuall asset,
     /// the asset manager uses this to determine if it is safe to purge
     virtual bool unique() const = 0;
 
+    /// the memory cost for the budgets of the collection, zero if unknown
+    virtual cost_t cost() const { return {0, 0}; }
+
+    /// the frame of the collection it's last loaded/requested
+    uint32_t last_used() const { return _last_used; }
+
+    /// the names of the assets loaded before this one
+    /// (see asset_collection::add_dependency)
+    std::vector<std::string> const& dependencies() const { return _dependencies; }
+
     /// sub-class to define this function to return the asset pointer
     /// it can be a raw pointer, shared_ptr or ref_ptr or anything the
     /// asset dictates
@@ -41,17 +61,29 @@ public:
 protected:
     asset_handle() = default;
     
+    /// the part of the loading which can run on the worker threads before
+    /// the load, i.e. reading and decoding, it shouldn't touch the
+    /// collection or the device; the load does it all if not prepared
+    virtual void prepare() {}
+
     /// load the resource from the source giving the assets mgr to load references
     virtual void load(asset_collection&) = 0;
 
     /// unload the resource but the meta data is kept to reload later
     virtual void unload() = 0;
 
-    // TODO: asynch load, signal, future etc.
-    // maintain internal state per handle, thread may be queued in managers
+    /// take over the source of the fresh handle (of the same type), the
+    /// loaded asset is reloaded in place so this handle is kept for the
+    /// dependents; false if it can't
+    virtual bool reload(asset_handle& fresh, asset_collection&) { return false; }
+
+private:
+    uint32_t _last_used = 0;    // managed by the collection
+    std::vector<std::string> _dependencies;
 
     friend class asset_manager; // TODO: remove this
     friend class asset_collection;
+    friend class asset_workers;
 };
 
 // Helper class for asset handle that manages the resource
@@ -61,10 +93,11 @@ class functor_asset_handle : public asset_handle {
 public:
     typedef typename T::ptr ptr_t;
     typedef std::function<void (ptr_t&, asset_collection&)> loader_t;
+    typedef std::function<void ()> preparer_t;
     
 public:
-    functor_asset_handle(loader_t const& loader)
-    : _loader(loader) {
+    functor_asset_handle(loader_t const& loader, preparer_t const& preparer = nullptr)
+    : _loader(loader), _preparer(preparer) {
     }
     
     virtual bool is_loaded() const override {
@@ -95,6 +128,11 @@ protected:
         return true;// _asset_ptr.unique();
     }
 
+    virtual void prepare() override {
+        if (_preparer)
+            _preparer();
+    }
+
     virtual void load(asset_collection& am) override {
         if (is_loaded())
             return;
@@ -104,10 +142,34 @@ protected:
     virtual void unload() override {
         _asset_ptr.reset();
     }
+
+    virtual bool reload(asset_handle& fresh, asset_collection& am) override {
+        auto* source = dynamic_cast<functor_asset_handle*>(&fresh);
+        if (source == nullptr)
+            return false;
+
+        _loader = source->_loader;
+        _preparer = source->_preparer;
+        if (!is_loaded())
+            return true;
+
+        ptr_t asset;
+        _loader(asset, am);
+        if (asset.get() == nullptr)
+            return false;
+        replace(std::move(asset));
+        return true;
+    }
+
+    /// the reloaded asset, the holders of the old one keep it by default
+    virtual void replace(ptr_t&& asset) {
+        _asset_ptr = std::move(asset);
+    }
     
 protected:
     ptr_t _asset_ptr;
     loader_t _loader;
+    preparer_t _preparer;
 };
 
 // asset_handle placeholder, any asset needs to specialize this class
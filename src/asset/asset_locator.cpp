@@ -1,8 +1,10 @@
 #include "asset/asset_locator.h"
 #include "io/file_stream.h"
+#include "io/mapped_stream.h"
 #include "common/log.h"
 
 #include <queue>
+#include <set>
 #include <algorithm>
 #include <unistd.h>
 #include <sys/stat.h>
@@ -11,6 +13,38 @@
 DEFINE_SINGLETON(locator_mgr);
 INHERIT_LOGGER(locator_mgr, data_stream);
 
+namespace {
+    // the entries of the directory (ends with '/') stat'ed, following the
+    // links; the type of the entry isn't always known without (d_type)
+    template<class F>
+    void list_dir(std::string const& dir, F const& visit) {
+        DIR* dp = opendir(dir.c_str());
+        if (dp == NULL)
+            return;
+        
+        struct dirent* entry;
+        while ((entry = readdir(dp))) {
+            if (strcmp(entry->d_name, ".") == 0 ||
+                strcmp(entry->d_name, "..") == 0)
+                continue;
+            
+            struct stat st;
+            auto full = dir + entry->d_name;
+            if (stat(full.c_str(), &st) == 0)
+                visit(entry->d_name, full, st);
+        }
+        closedir(dp);
+    }
+    
+    int64_t modified_of(struct stat const& st) {
+#ifdef __APPLE__
+        return (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+        return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    }
+}
+
 struct priority_sorter {
     bool operator() (locator_mgr::locator_ptr const& lhs,
                      locator_mgr::locator_ptr const& rhs) const {
@@ -20,6 +54,10 @@ struct priority_sorter {
 
 void locator_mgr::sort_locators() {
     std::sort(_locators.begin(), _locators.end(), priority_sorter());
+    
+    // the new ones may override
+    std::lock_guard<std::mutex> lock(_mutex);
+    _lookups.clear();
 }
 
 data_stream::ptr locator_mgr::from(std::string const& name) const {
@@ -29,19 +67,52 @@ data_stream::ptr locator_mgr::from(std::string const& name) const {
         return nullptr;
     }
     
+    // the cached one, either the locator or missing
+    asset_locator const* cached = nullptr;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _lookups.find(name);
+        if (it != _lookups.end())
+            found = true, cached = it->second;
+    }
+    
+    if (found && cached == nullptr) {
+        LOG_WARN(name << " couldn't be found.");
+        return nullptr;
+    } else if (found) {
+        auto stream = cached->from(name);
+        if (stream.get() != nullptr)
+            return stream;
+    }
+    
     LOG_TRACE("loading stream: " << name);
     for (auto& it : _locators) {
         LOG_TRACE("searching in:" << it->name());
         auto stream = it->from(name);
         if (stream.get() != nullptr) {
             LOG_TRACE("found");
+            std::lock_guard<std::mutex> lock(_mutex);
+            _lookups[name] = it.get();
             return stream;
         }
     }
+    
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _lookups[name] = nullptr;
+    }
     LOG_WARN(name << " couldn't be found.");
     return nullptr;
 }
 
+void locator_mgr::invalidate() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _lookups.clear();
+    for (auto& it : _locators)
+        it->invalidate();
+}
+
 locator_mgr& locator_mgr::add_locator(int level, char const* base, char const* sub) {
     using namespace locator;
     if (base[0] == '@') {
@@ -53,7 +124,12 @@ locator_mgr& locator_mgr::add_locator(int level, char const* base, char const* s
             add(locator::dir_locator::cur_dir(level, sub));
         }
     } else {
-        add(dir_locator::ptr(new dir_locator(std::string(base) + sub, level)));
+        std::string path = std::string(base) + sub;
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+            add(archive_locator::open(path, level));
+        else
+            add(dir_locator::ptr(new dir_locator(path, level)));
     }
     return *this;
 }
@@ -69,59 +145,132 @@ namespace locator {
         }
     }
 
-    bool dir_locator::contains(std::string const& name) const {
-        struct stat st;
-        auto full = _base + name;
+    bool dir_locator::find(std::string const& name, size_t& size) const {
+        auto slash = name.rfind('/');
+        auto dir = slash == std::string::npos ? std::string() : name.substr(0, slash + 1);
+        
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _dirs.find(dir);
+        if (it == _dirs.end()) {
+            // only the directory of the name, not the whole tree
+            lock.unlock();
+            names_t files;
+            list_dir(_base + dir, [&] (char const* file, std::string const&, struct stat const& st) {
+                if (S_ISREG(st.st_mode))
+                    files.emplace(file, file_t{(size_t)st.st_size, modified_of(st)});
+            });
+            lock.lock();
+            it = _dirs.emplace(dir, std::move(files)).first;
+        }
         
-        return stat(full.c_str(), &st) == 0 && (S_ISREG(st.st_mode));
+        auto file = it->second.find(name.substr(dir.length()));
+        if (file == it->second.end())
+            return false;
+        size = file->second.size;
+        return true;
+    }
+    
+    void dir_locator::invalidate() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _dirs.clear();
+    }
+    
+    bool dir_locator::contains(std::string const& name) const {
+        size_t size;
+        return find(name, size);
     }
     
     data_stream::ptr dir_locator::from(std::string const& name) const {
-        struct stat st;
+        size_t size;
+        if (!find(name, size))
+            return nullptr;
+        
+        // the large ones are read in place without copying
         auto full = _base + name;
+        if (size >= MapThreshold) {
+            auto mapped = mapped_stream::open(full.c_str());
+            if (mapped)
+                return std::move(mapped);
+        }
         
-        if(stat(full.c_str(), &st) != 0 ||
-           !S_ISREG(st.st_mode))
+        // it's removed since listed
+        data_stream::ptr stream(new file_stream(full.c_str()));
+        if (!stream->valid())
             return nullptr;
-        
-        return data_stream::ptr(new file_stream(full.c_str()));
+        return stream;
     }
 
-    void dir_locator::traverse(visitor_t const& visitor) const {        
-        std::queue<std::string> dirs;
-        dirs.emplace(_base);
+    void dir_locator::walk(walker_t const& walker) const {
+        std::unique_ptr<names_t> names(new names_t());
+        dirs_t dirs;
+        std::queue<std::string> pending;
+        pending.emplace("");
         
-        while (!dirs.empty()) {
-            auto& cur = dirs.front();
-            
-            struct dirent *entry;
-            DIR *dp;
+        // the linked directories are walked once, even in a loop
+        std::set<std::pair<dev_t, ino_t>> visited;
+        struct stat root;
+        if (stat(_base.c_str(), &root) == 0)
+            visited.emplace(root.st_dev, root.st_ino);
+        
+        while (!pending.empty()) {
+            auto dir = std::move(pending.front());
+            pending.pop();
             
-            dp = opendir(cur.c_str());
-            if (dp == NULL) {
-                dirs.pop();
-                continue;
-            }
-
-            auto base = std::string(cur.data() + _base.length());
-            while ((entry = readdir(dp))) {
-                if (strcmp(entry->d_name, ".") == 0 ||
-                    strcmp(entry->d_name, "..") == 0) {
-                    continue;
-                } else if (entry->d_type == DT_DIR) {
-                    dirs.emplace(cur + entry->d_name + '/');
-                } else if (cur.length() == _base.length()) {
-                    visitor(std::string(entry->d_name),
-                            data_stream::ptr(new file_stream((cur + entry->d_name).c_str())));
-                } else {
-                    visitor(base + entry->d_name,
-                            data_stream::ptr(new file_stream((cur + entry->d_name).c_str())));
+            auto& files = dirs[dir];
+            list_dir(_base + dir, [&] (char const* file, std::string const& full, struct stat const& st) {
+                if (S_ISDIR(st.st_mode)) {
+                    if (visited.emplace(st.st_dev, st.st_ino).second)
+                        pending.emplace(dir + file + '/');
+                    return;
+                } else if (!S_ISREG(st.st_mode)) {
+                    return;
                 }
-            }
-            
-            dirs.pop();
-            closedir(dp);
+                
+                auto name = dir + file;
+                files.emplace(file, file_t{(size_t)st.st_size, modified_of(st)});
+                names->emplace(name, file_t{(size_t)st.st_size, modified_of(st)});
+                if (walker)
+                    walker(name, full);
+            });
+        }
+        
+        std::lock_guard<std::mutex> lock(_mutex);
+        _names = std::move(names);
+        _dirs = std::move(dirs);
+    }
+    
+    std::vector<std::string> dir_locator::changes() const {
+        std::unique_ptr<names_t> last;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_names)
+                last.reset(new names_t(*_names));
+        }
+        
+        // the first walk is the base line
+        walk(nullptr);
+        if (!last)
+            return {};
+        
+        std::vector<std::string> changed;
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& it : *_names) {
+            auto was = last->find(it.first);
+            if (was == last->end() || was->second != it.second)
+                changed.push_back(it.first);
+        }
+        for (auto& it : *last) {
+            if (_names->find(it.first) == _names->end())
+                changed.push_back(it.first);
         }
+        return changed;
+    }
+    
+    void dir_locator::traverse(visitor_t const& visitor) const {
+        // the names are cached along
+        walk([&] (std::string const& name, std::string const& full) {
+            visitor(name, data_stream::ptr(new file_stream(full.c_str())));
+        });
     }
     
     dir_locator::ptr dir_locator::cur_dir(int priority, char const* sub) {
@@ -133,4 +282,34 @@ namespace locator {
         free(cur_dir);
         return ptr(dir);
     }
-}
\ No newline at end of file
+    
+#pragma mark - archive
+    
+    archive_locator::archive_locator(archive::ptr const& pack, std::string const& name, int priority)
+    : asset_locator(priority), _archive(pack), _name(name) {
+    }
+    
+    archive_locator::ptr archive_locator::open(std::string const& filename, int priority) {
+        auto pack = archive::open(filename.c_str());
+        if (!pack) {
+            LOG_ERROR(locator_mgr, "unable to open the archive: " << filename);
+            return nullptr;
+        }
+        return ptr(new archive_locator(pack, filename, priority));
+    }
+    
+    bool archive_locator::contains(std::string const& name) const {
+        return _archive->find(name) != nullptr;
+    }
+    
+    data_stream::ptr archive_locator::from(std::string const& name) const {
+        auto* entry = _archive->find(name);
+        return entry != nullptr ? _archive->from(*entry) : nullptr;
+    }
+    
+    void archive_locator::traverse(visitor_t const& visitor) const {
+        _archive->traverse([&] (std::string const& name, archive_entry const& entry) {
+            visitor(name, _archive->lazy(entry));
+        });
+    }
+}
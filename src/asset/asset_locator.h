@@ -1,11 +1,16 @@
 #ifndef _ASSET_LOCATOR_H
 #define _ASSET_LOCATOR_H
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "common/singleton.h"
 #include "io/data_stream.h"
+#include "io/archive.h"
 
 class asset_locator;
 
@@ -78,6 +83,7 @@ public:
     /// add a locator, it will concatenate the two strings
     /// @param base, @home or @app, the predefined path, or absolute path
     /// @param sub, the subfolder path
+    /// the packed archive is added if the path is a file (see archive.h)
     locator_mgr& add_locator(int level, char const* base, char const* sub = "");
     
     // get a stream by looking up the locators by priority
@@ -86,8 +92,17 @@ public:
     // sort locators by priority
     void sort_locators();
     
+    /// drop the cached lookups of all the locators, i.e. the files
+    /// are added or removed since
+    void invalidate();
+    
 private:
+    // the locator of the name, null for the missing ones
+    typedef std::unordered_map<std::string, asset_locator const*> lookups_t;
+    
     locators_t _locators;
+    mutable lookups_t _lookups;
+    mutable std::mutex _mutex;
 };
 
 IMPORT_SINGLETON(locator_mgr);
@@ -113,6 +128,13 @@ public:
     // the name for the locator
     virtual std::string name() const { return "(null)"; }
     
+    // drop the cached names if any, see locator_mgr::invalidate
+    virtual void invalidate() const {}
+    
+    // the names modified, added or removed since the last call (or the
+    // first traversal), none if it can't tell
+    virtual std::vector<std::string> changes() const { return {}; }
+    
     // the priority to look up the asset so the 'local' asset
     // will be able to override. probably change to a different
     // approach
@@ -129,6 +151,9 @@ private:
 
 namespace locator {
     class dir_locator : public asset_locator {
+    public:
+        enum { MapThreshold = 64 * 1024 };  // the files mapped (see mapped_stream), in bytes
+        
     public:
         dir_locator(std::string const&, int = 0);
         
@@ -136,12 +161,56 @@ namespace locator {
         virtual data_stream::ptr from(std::string const&) const override;
         virtual void traverse(visitor_t const&) const override;
         virtual std::string name() const override { return _base; }
+        virtual void invalidate() const override;
+        virtual std::vector<std::string> changes() const override;
 
         static ptr home_dir(int priority = 0, char const* sub = "");
         static ptr app_dir(int priority = 1, char const* sub = "");
         static ptr cur_dir(int priority = 2, char const* sub = "");
     private:
+        // the size and the modified time (ns) of a file
+        struct file_t {
+            size_t size;
+            int64_t modified;
+            
+            bool operator!=(file_t const& rhs) const {
+                return size != rhs.size || modified != rhs.modified;
+            }
+        };
+        typedef std::unordered_map<std::string, file_t> names_t;
+        typedef std::unordered_map<std::string, names_t> dirs_t;
+        typedef std::function<void(std::string const&, std::string const&)> walker_t;
+        
+        void walk(walker_t const&) const;
+        bool find(std::string const&, size_t& size) const;
+        
         std::string _base;
+        // the files of the directories listed so far, by the relative paths
+        // ("" for the base, "sub/"); a lookup lists its directory once
+        // instead of a stat each, the names out of it are missing
+        mutable dirs_t _dirs;
+        // all the files by the relative names as of the last walk, the base
+        // line of the changes
+        mutable std::unique_ptr<names_t> _names;
+        mutable std::mutex _mutex;
+    };
+    
+    /// the entries of a packed archive (see archive.h)
+    class archive_locator : public asset_locator {
+    public:
+        archive_locator(archive::ptr const&, std::string const& name, int = 0);
+        
+        /// null if it's not a valid archive
+        static ptr open(std::string const& filename, int priority = 0);
+        
+        virtual bool contains(std::string const&) const override;
+        virtual data_stream::ptr from(std::string const&) const override;
+        virtual void traverse(visitor_t const&) const override;
+        virtual std::string name() const override { return _name; }
+        
+    private:
+        archive::ptr _archive;
+        std::string _name;
     };
 };
 #endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "asset/asset_manager.h"
 #include "asset/asset_bundle.h"
 #include "common/log.h"
+#include <algorithm>
 
 DEFINE_LOGGER(asset_manager, "asset");
 
@@ -48,9 +49,37 @@ std::pair<uint32_t, uint32_t> asset_manager::add_from_bundle(asset_bundle *bundl
     return {assets.size(), replaced};
 }
 
+uint32_t asset_manager::reload_from_bundle(asset_bundle *bundle) {
+    assert(bundle != nullptr);
+    
+    LOG_INFO("start to reload assets from bundle:" << bundle->name());
+    auto reloaded = (uint32_t)reload(bundle->changes());
+    LOG_INFO("finish (" << reloaded << ")");
+    return reloaded;
+}
+
+std::pair<uint32_t, uint32_t> asset_manager::add_bundle(std::shared_ptr<asset_bundle> const& bundle) {
+    assert(bundle);
+    
+    if (std::find(_bundles.begin(), _bundles.end(), bundle) == _bundles.end())
+        _bundles.push_back(bundle);
+    return add_from_bundle(bundle.get());
+}
+
+uint32_t asset_manager::reload_changes() {
+    uint32_t reloaded = 0;
+    for (auto& it : _bundles)
+        reloaded += reload_from_bundle(it.get());
+    return reloaded;
+}
+
 uint32_t asset_manager::remove_from_bundle(asset_bundle *bundle) {
     assert(bundle != nullptr);
     
+    _bundles.erase(std::remove_if(_bundles.begin(), _bundles.end(), [=] (std::shared_ptr<asset_bundle> const& it) {
+        return it.get() == bundle;
+    }), _bundles.end());
+    
     auto assets = bundle->assets();
     uint32_t num = 0;
     for (auto& it : assets) {
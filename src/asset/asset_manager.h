@@ -23,6 +23,22 @@ public:
     // returns the number of item being added and replaced
     std::pair<uint32_t, uint32_t> add_from_bundle(asset_bundle*);
     uint32_t remove_from_bundle(asset_bundle*);
+
+    // reload the changed assets of the bundle in place (see
+    // asset_bundle::changes), the new ones are added too;
+    // returns the number reloaded
+    uint32_t reload_from_bundle(asset_bundle*);
+    
+    // keep the bundle to be polled for the changes (see reload_changes)
+    // and add the assets from it
+    std::pair<uint32_t, uint32_t> add_bundle(std::shared_ptr<asset_bundle> const&);
+    
+    // reload the changed assets of all the kept bundles, i.e. polled
+    // every while for the hot reloading; returns the number reloaded
+    uint32_t reload_changes();
+    
+private:
+    std::vector<std::shared_ptr<asset_bundle>> _bundles;
 };
 
 // convenient asset manager singleton
@@ -0,0 +1,160 @@
+#include "asset/asset_request.h"
+#include <algorithm>
+#include <cassert>
+
+#pragma mark - asset request
+
+bool asset_request::cancel() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    switch (state()) {
+        case Queued:
+        case Prepared:
+            _state.store(Cancelled, std::memory_order_release);
+            return true;
+        case Preparing:
+            _cancelling = true;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool asset_request::start() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (state() != Queued)
+        return false;
+    _state.store(Preparing, std::memory_order_release);
+    return true;
+}
+
+void asset_request::finish() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    assert(state() == Preparing);
+    _state.store(_cancelling ? Cancelled : Prepared, std::memory_order_release);
+    _cancelling = false;
+}
+
+bool asset_request::revive() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (state() == Cancelled)
+        return false;
+    _cancelling = false;
+    return true;
+}
+
+void asset_request::set_loaded() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _state.store(Loaded, std::memory_order_release);
+}
+
+#pragma mark - asset preload
+
+size_t asset_preload::loaded() const {
+    return std::count_if(_requests.begin(), _requests.end(), [] (asset_request::ptr const& request) {
+        return request->ready();
+    });
+}
+
+bool asset_preload::done() const {
+    return std::all_of(_requests.begin(), _requests.end(), [] (asset_request::ptr const& request) {
+        auto state = request->state();
+        return state == asset_request::Loaded || state == asset_request::Cancelled;
+    });
+}
+
+void asset_preload::cancel() {
+    for (auto& request : _requests)
+        request->cancel();
+}
+
+#pragma mark - asset workers
+
+asset_workers::asset_workers(size_t threads) {
+    if (threads == 0) {
+        size_t cores = std::thread::hardware_concurrency();
+        threads = cores > 1 ? std::min<size_t>(cores - 1, 4) : 1;
+    }
+
+    for (size_t i = 0; i < threads; ++i)
+        _threads.emplace_back(&asset_workers::run, this);
+}
+
+asset_workers::~asset_workers() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+        for (auto& it : _queue)
+            it->cancel();
+        _queue.clear();
+    }
+    _wake.notify_all();
+
+    for (auto& it : _threads)
+        it.join();
+}
+
+asset_request::ptr asset_workers::push(asset_handle::ptr const& handle, int priority) {
+    asset_request::ptr request;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        request = std::make_shared<asset_request>(handle, priority, ++ _sequence);
+        _queue.push_back(request);
+        std::push_heap(_queue.begin(), _queue.end(), asset_request::less());
+    }
+    _wake.notify_one();
+    return request;
+}
+
+asset_workers::requests_t asset_workers::take_finished() {
+    requests_t finished;
+    std::lock_guard<std::mutex> lock(_mutex);
+    finished.swap(_finished);
+    return finished;
+}
+
+void asset_workers::wait(asset_request& request) {
+    // the cancelled/queued ones are left in the queue, workers skip them
+    if (request.start()) {
+        prepare(request);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [&] () { return request.state() != asset_request::Preparing; });
+}
+
+void asset_workers::prepare(asset_request& request) {
+    request._handle->prepare();
+    request.finish();
+}
+
+void asset_workers::run() {
+    for (;;) {
+        asset_request::ptr request;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [this] () { return _stop || !_queue.empty(); });
+            if (_stop)
+                return;
+
+            std::pop_heap(_queue.begin(), _queue.end(), asset_request::less());
+            request = std::move(_queue.back());
+            _queue.pop_back();
+        }
+
+        // taken by the main thread, or cancelled; the cancelled ones are
+        // handed back too so the collection drops them from the pending
+        if (!request->start()) {
+            if (request->state() != asset_request::Cancelled)
+                continue;
+        } else {
+            prepare(*request);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _finished.push_back(std::move(request));
+        }
+        _done.notify_all();
+    }
+}
@@ -0,0 +1,148 @@
+#ifndef _CHAOS3D_ASSET_ASSET_REQUEST_H
+#define _CHAOS3D_ASSET_ASSET_REQUEST_H
+
+#include "asset/asset_handle.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class asset_workers;
+
+/// the asynchronous loading request of an asset, like a future
+///
+/// the handle is prepared (IO/decoding, see asset_handle::prepare) on
+/// the worker threads by the priority, and loaded (i.e. GPU upload) on
+/// the main thread by asset_collection::update, or right away by
+/// asset_collection::wait.
+class asset_request : public std::enable_shared_from_this<asset_request> {
+public:
+    typedef std::shared_ptr<asset_request> ptr;
+
+    enum state_t {
+        Queued,         // waiting for a worker
+        Preparing,      // on a worker (or the main thread waiting)
+        Prepared,       // to load on the main thread
+        Loaded,         // done, the asset is ready
+        Cancelled,
+    };
+
+public:
+    asset_request(asset_handle::ptr const& handle, int priority, uint64_t sequence)
+    : _handle(handle), _priority(priority), _sequence(sequence), _state(Queued)
+    {}
+
+    state_t state() const { return (state_t)_state.load(std::memory_order_acquire); }
+
+    /// whether the asset is loaded
+    bool ready() const { return state() == Loaded; }
+
+    /// cancel it unless it's loaded already, the one being prepared is
+    /// cancelled once it's done; the prepared data, if any, is kept in the
+    /// handle to the next load
+    bool cancel();
+
+    int priority() const { return _priority; }
+    asset_handle::ptr const& handle() const { return _handle; }
+
+    /// the asset, only when it's ready
+    template<class T>
+    typename T::ptr get() const {
+        if (!ready())
+            return nullptr;
+        return _handle->as<asset_handle_base<T>>().get_asset();
+    }
+
+    // higher priority first, then the earlier ones
+    struct less {
+        bool operator()(ptr const& lhs, ptr const& rhs) const {
+            return lhs->_priority < rhs->_priority ||
+                (lhs->_priority == rhs->_priority && lhs->_sequence > rhs->_sequence);
+        }
+    };
+
+private:
+    // the transitions, see asset_request.cpp
+    bool start();
+    void finish();
+    bool revive();
+    void set_loaded();
+
+    asset_handle::ptr _handle;
+    int _priority;
+    uint64_t _sequence;
+    std::atomic<int> _state;        // changed with the mutex locked
+    bool _cancelling = false;       // cancelled while preparing
+    std::mutex _mutex;
+
+    friend class asset_workers;
+    friend class asset_collection;
+};
+
+/// the progress of a preload (see asset_collection::preload), the requests
+/// are in the loading order, the dependencies first
+class asset_preload : public std::enable_shared_from_this<asset_preload> {
+public:
+    typedef std::shared_ptr<asset_preload> ptr;
+    typedef std::vector<asset_request::ptr> requests_t;
+
+public:
+    size_t total() const { return _requests.size(); }
+    size_t loaded() const;
+
+    /// the loaded ones in [0, 1]
+    float progress() const { return total() > 0 ? (float)loaded() / total() : 1.f; }
+
+    /// all loaded or cancelled
+    bool done() const;
+
+    /// cancel the pending ones
+    void cancel();
+
+    requests_t const& requests() const { return _requests; }
+
+private:
+    requests_t _requests;
+
+    friend class asset_collection;
+};
+
+/// the worker threads preparing the requests
+class asset_workers {
+public:
+    typedef std::vector<asset_request::ptr> requests_t;
+
+public:
+    /// 0 for the number of the cores but the main thread
+    asset_workers(size_t threads = 0);
+
+    /// the queued ones are dropped, the preparing ones finish first
+    ~asset_workers();
+
+    asset_request::ptr push(asset_handle::ptr const&, int priority);
+
+    /// take the finished ones (prepared or cancelled)
+    requests_t take_finished();
+
+    /// prepare on the calling thread if it's still queued, otherwise
+    /// wait for the worker to finish
+    void wait(asset_request&);
+
+private:
+    void run();
+    void prepare(asset_request&);
+
+    std::mutex _mutex;
+    std::condition_variable _wake, _done;
+    requests_t _queue;              // heap, by asset_request::less
+    requests_t _finished;
+    std::vector<std::thread> _threads;
+    uint64_t _sequence = 0;
+    bool _stop = false;
+};
+
+#endif
@@ -1,6 +1,8 @@
 #include "asset/locator_asset_bundle.h"
 #include "asset/asset_loader.h"
 #include "io/file_stream.h"
+#include "common/log.h"
+#include <sstream>
 
 locator_asset_bundle::locator_asset_bundle(asset_locator::ptr const& locator,
                                            loaders_t && loaders,
@@ -13,23 +15,97 @@ locator_asset_bundle::~locator_asset_bundle() {
     // blank on purpose
 }
 
+namespace {
+    // the manifest of the dependencies in the bundle root
+    const char* dependencies_manifest = "dependencies.txt";
+
+    // remove the extension
+    std::string asset_name(std::string const& name) {
+        auto dot = name.find_last_of(".");
+        auto split = name.find_last_of("/"); //FIXME: windows use back slash
+        if (split == std::string::npos)
+            split = 0;
+        if (dot == std::string::npos)
+            dot = name.length();
+
+        return std::string(name.c_str(), dot > split ? dot : name.length());
+    }
+}
+
 void locator_asset_bundle::load_assets() {
     _locator->traverse([&] (std::string const& name, data_stream::ptr&& stream) {
-        for (auto& loader : loaders()) {
-            if (loader->can_load(stream.get())) {
-                auto dot = name.find_last_of(".");
-                auto split = name.find_last_of("/"); //FIXME: windows use back slash
-                if (split == std::string::npos)
-                    split = 0;
-                if (dot == std::string::npos)
-                    dot = name.length();
-
-                // remove the extension
-                add(std::string(name.c_str(), dot > split ? dot : name.length()),
-                    loader->load(std::move(stream)));
-
-                break;
-            }
-        }
+        auto handle = load_stream(std::move(stream));
+        if (handle)
+            add(asset_name(name), handle);
     });
+    load_dependencies();
+}
+
+void locator_asset_bundle::load_dependencies() {
+    auto stream = _locator->from(dependencies_manifest);
+    if (!stream)
+        return;
+
+    std::string text(stream->size(), '\0');
+    text.resize(stream->read(&text[0], text.size()));
+
+    // one asset a line: "name: dependency another", '#' for comments
+    std::istringstream lines(text);
+    std::string line;
+    size_t added = 0;
+    while (std::getline(lines, line)) {
+        auto colon = line.find(':');
+        if (line.empty() || line[0] == '#' || colon == std::string::npos)
+            continue;
+
+        std::istringstream name_in(line.substr(0, colon)), dependencies(line.substr(colon + 1));
+        std::string name, dependency;
+        if (!(name_in >> name))
+            continue;
+        while (dependencies >> dependency) {
+            if (add_dependency(name, dependency))
+                ++ added;
+        }
+    }
+    LOG_INFO("dependencies declared: " << added << " in " << name());
+}
+
+asset_bundle::handle_ptr locator_asset_bundle::load_stream(data_stream::ptr&& stream) const {
+    for (auto& loader : loaders()) {
+        if (loader->can_load(stream.get()))
+            return loader->load(std::move(stream));
+    }
+    return nullptr;
+}
+
+asset_bundle::handles_t locator_asset_bundle::changes() {
+    handles_t changed;
+    bool manifest = false;
+    for (auto& name : _locator->changes()) {
+        if (name == dependencies_manifest) {
+            manifest = true;
+            continue;
+        }
+
+        auto stream = _locator->from(name);
+        if (!stream) {
+            LOG_INFO("asset removed: " << name);
+            continue;
+        }
+
+        auto handle = load_stream(std::move(stream));
+        if (!handle)
+            continue;
+
+        // the existing ones are reloaded in place by the collection
+        auto key = asset_name(name);
+        if (!contains(key))
+            add(key, handle);
+        changed.emplace(std::move(key), std::move(handle));
+    }
+
+    // the new edges are added, the ones removed stay until reopened
+    if (manifest)
+        load_dependencies();
+    return changed;
 }
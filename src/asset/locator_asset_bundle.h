@@ -12,6 +12,10 @@
 // the same type (.png); this may only produce one type
 // of resources (texture). The file type itself can be
 // a meta or produce several types of resources as well.
+// The dependencies among the assets are declared in the
+// "dependencies.txt" manifest, one asset a line:
+//   skeleton: skeleton_atlas
+//   skeleton_atlas: skeleton_texture
 class locator_asset_bundle : public asset_bundle {
 public:
     /// destructor to remove dependencies on member variables
@@ -25,9 +29,20 @@ public:
     asset_locator::ptr const& locator() const { return _locator;}
     virtual std::string name() const override { return _locator->name(); }
     
+    /// only the changed files by the locator (see asset_locator::changes)
+    /// are loaded again; the new ones are added to this bundle, the removed
+    /// ones are kept as they may be in use
+    virtual handles_t changes() override;
+    
 private:
     // load asset meta: name -> handle
     void load_assets();
+    
+    // add the dependencies declared in the manifest, if any
+    void load_dependencies();
+    
+    // the handle of the stream by the loaders, null if none can load it
+    handle_ptr load_stream(data_stream::ptr&&) const;
 
     asset_locator::ptr _locator;
 
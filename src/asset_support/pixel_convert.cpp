@@ -0,0 +1,46 @@
+#include "asset_support/pixel_convert.h"
+
+namespace {
+    // x / 255 rounded, exact for x in [0, 255 * 255]
+    inline uint32_t div255(uint32_t x) {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+    
+    // 8 bits to n bits, rounded
+    template<uint32_t Max>
+    inline uint32_t scale(uint32_t c) {
+        return div255(c * Max);
+    }
+}
+
+void pixel::premultiply(uint8_t* rgba, size_t count) {
+    for (size_t i = 0; i < count; ++i, rgba += 4) {
+        uint32_t a = rgba[3];
+        rgba[0] = (uint8_t)div255(rgba[0] * a);
+        rgba[1] = (uint8_t)div255(rgba[1] * a);
+        rgba[2] = (uint8_t)div255(rgba[2] * a);
+    }
+}
+
+void pixel::to_rgb565(uint8_t const* __restrict rgba, uint16_t* __restrict out, size_t count) {
+    for (size_t i = 0; i < count; ++i, rgba += 4)
+        out[i] = (uint16_t)((scale<31>(rgba[0]) << 11) | (scale<63>(rgba[1]) << 5) | scale<31>(rgba[2]));
+}
+
+void pixel::to_rgba4444(uint8_t const* __restrict rgba, uint16_t* __restrict out, size_t count) {
+    for (size_t i = 0; i < count; ++i, rgba += 4)
+        out[i] = (uint16_t)((scale<15>(rgba[0]) << 12) | (scale<15>(rgba[1]) << 8) |
+                            (scale<15>(rgba[2]) << 4) | scale<15>(rgba[3]));
+}
+
+void pixel::to_alpha(uint8_t const* __restrict rgba, uint8_t* __restrict out, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+        out[i] = rgba[i * 4 + 3];
+}
+
+void pixel::to_luminance(uint8_t const* __restrict rgba, uint8_t* __restrict out, size_t count) {
+    // BT.709 in 8 bits fixed point, the weights sum to 256
+    for (size_t i = 0; i < count; ++i, rgba += 4)
+        out[i] = (uint8_t)((rgba[0] * 54 + rgba[1] * 183 + rgba[2] * 19 + 128) >> 8);
+}
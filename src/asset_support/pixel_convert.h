@@ -0,0 +1,26 @@
+#ifndef _CHAOS3D_ASSET_SUPPORT_PIXEL_CONVERT_H
+#define _CHAOS3D_ASSET_SUPPORT_PIXEL_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/// the pixel conversions of the decoded images (RGBA8888)
+///
+/// the loops are branchless and the buffers don't overlap so they're
+/// vectorized by the compiler (NEON/SSE), the channels are rounded
+/// rather than truncated.
+namespace pixel {
+    /// multiply the colors by the alpha, in place
+    void premultiply(uint8_t* rgba, size_t count);
+    
+    void to_rgb565(uint8_t const* rgba, uint16_t* out, size_t count);
+    void to_rgba4444(uint8_t const* rgba, uint16_t* out, size_t count);
+    
+    /// the alpha channel only
+    void to_alpha(uint8_t const* rgba, uint8_t* out, size_t count);
+    
+    /// the luminance as the alpha, i.e. the masks without alpha
+    void to_luminance(uint8_t const* rgba, uint8_t* out, size_t count);
+}
+
+#endif
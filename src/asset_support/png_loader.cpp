@@ -3,8 +3,13 @@
 #include "common/log.h"
 
 #include "asset_support/texture_asset.h"
+#include "asset_support/pixel_convert.h"
+#include "asset_support/raw_texture.h"
+#include "io/mapped_stream.h"
 #include "re/render_device.h"
 #include <png.h>
+#include <cstdio>
+#include <sys/stat.h>
 
 static void PNGAPI user_read_data_fcn(png_structp png_ptr, png_bytep data, png_size_t length){
     png_size_t check;
@@ -18,15 +23,18 @@ static void PNGAPI user_read_data_fcn(png_structp png_ptr, png_bytep data, png_s
     }
 }
 
-static void load_png(data_stream& ds, png_loader::image_data& img_data) {
-    //TODO: fix error loading
-
-    png_bytep *row_pointers = 0;
-    png_bytep data = 0;
+// decodes to RGBA8888, whether it has the alpha (or transparency)
+static void load_png(data_stream& ds, png_loader::image_data& img_data, bool premultiply, bool& has_alpha) {
+    // changed after setjmp, read by the error handling
+    png_bytep* volatile row_pointers = nullptr;
+    char* volatile data = nullptr;
 
     {
-        png_byte buffer[8];
-        assert((ds.read(buffer, 8) == 8) && png_sig_cmp(buffer, 0, 8) == 0);
+        png_byte signature[8];
+        if (ds.read(signature, 8) != 8 || png_sig_cmp(signature, 0, 8) != 0) {
+            LOG_ERROR(png_loader, "not a png file.");
+            return;
+        }
     }
 
     png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING,
@@ -47,10 +55,8 @@ static void load_png(data_stream& ds, png_loader::image_data& img_data) {
     // for proper error handling
     if (setjmp(png_jmpbuf(png_ptr))) {
         png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-        if (row_pointers)
-            delete [] row_pointers;
-        if ( data )
-            delete [] data;
+        delete [] row_pointers;
+        delete [] data;
         LOG_ERROR(png_loader, "reading PNG errors.");
         return;
     }
@@ -61,21 +67,12 @@ static void load_png(data_stream& ds, png_loader::image_data& img_data) {
 
     png_read_info(png_ptr, info_ptr); // Read the info section of the png file
 
-
-    int width, height;
+    png_uint_32 width, height;
     int bitDepth, colorType;
-    int channels = png_get_channels(png_ptr, info_ptr);
-
-    {
-        // Use temporary variables to avoid passing casted pointers
-        png_uint_32 w,h;
-        // Extract info
-        png_get_IHDR(png_ptr, info_ptr,
-                     &w, &h,
-                     &bitDepth, &colorType, NULL, NULL, NULL);
-        width = w;
-        height= h;
-    }
+    png_get_IHDR(png_ptr, info_ptr,
+                 &width, &height,
+                 &bitDepth, &colorType, NULL, NULL, NULL);
+    has_alpha = (colorType & PNG_COLOR_MASK_ALPHA) != 0;
 
     // Convert palette color to true color
     if (colorType == PNG_COLOR_TYPE_PALETTE)
@@ -89,74 +86,73 @@ static void load_png(data_stream& ds, png_loader::image_data& img_data) {
             png_set_packing(png_ptr);
     }
 
-    if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS))
+    if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS)) {
         png_set_tRNS_to_alpha(png_ptr);
+        has_alpha = true;
+    }
 
     // Convert high bit colors to 8 bit colors
     if (bitDepth == 16)
         png_set_strip_16(png_ptr);
 
-    if (img_data.desc.format == image_desc::A8 && channels != 1) {
-        // convert to grey scale and use it as an alpha mask
-        // and strip the alpha channel
-        png_set_strip_alpha(png_ptr);
-        png_set_rgb_to_gray(png_ptr, 1, 0.2109375, 0.71484375);
-    }
+    // all decoded to RGBA8888, then converted to the format
+    if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA)
+        png_set_gray_to_rgb(png_ptr);
+    if (!has_alpha)
+        png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
 
     // Update the changes
     png_read_update_info(png_ptr, info_ptr);
-    png_get_IHDR(png_ptr, info_ptr,
-                 (png_uint_32*)&width, (png_uint_32*)&height,
-                 &bitDepth, &colorType, NULL, NULL, NULL);
-    channels = png_get_channels(png_ptr, info_ptr);
-
-    img_data.desc.size = {width, height};
+    assert(png_get_channels(png_ptr, info_ptr) == 4);
 
     // Create array of pointers to rows in image data
+    size_t count = (size_t)width * height;
     row_pointers = new png_bytep[height];
-    img_data.buf_size = sizeof(png_byte) * width * height * channels;
-
-    char* buffer = new char [img_data.buf_size];
-    data = (png_bytep)buffer;
-
-    if (!row_pointers || !data) {
-        LOG_ERROR(png_loader, "unable to allocate enough memory.");
-        png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-        return;
-    }
+    data = new char [count * 4];
 
-    png_bytep rp = data;
-    for ( int i = 0 ; i < height ; ++i, rp += width * channels ){
+    png_bytep rp = (png_bytep)data;
+    for (png_uint_32 i = 0 ; i < height ; ++i, rp += width * 4){
         row_pointers[i] = rp;
     }
 
     // Read data using the library function that handles all transformations including interlacing
     png_read_image(png_ptr, row_pointers);
-
-    if (img_data.desc.format == image_desc::A8 && channels != 1) {
-        assert(0); // shouldn't happen?
-    } else if (img_data.desc.format == image_desc::RGB565) {
-        unsigned char* tempData = new unsigned char[width * height * 2];
-        unsigned char* in = data;
-        unsigned short* out = (unsigned short*)tempData;
-
-        for (int i = 0; i < width * height; ++i, in += channels)
-            *out++ = ((unsigned short)(*in >> 3)<<11) |
-            ((unsigned short)(*(in+1) >> 2)<<5) |
-            ((unsigned short)(*(in+2) >> 3));
-        
-        delete [] data;
-    }
-    
     png_read_end(png_ptr, NULL);
+
     delete [] row_pointers;
-    
     png_destroy_read_struct(&png_ptr,&info_ptr, 0); // Clean up memory
-    
-    img_data.buffer.reset(buffer);
+
+    if (premultiply && has_alpha)
+        pixel::premultiply((uint8_t*)data, count);
+
+    img_data.desc.size = {(int)width, (int)height};
+    img_data.buf_size = count * 4;
+    img_data.buffer.reset(data);
 }
 
-png_loader::png_loader(render_device* rd) : _device(rd) {
+// the cached container by the content, the format and the premultiply
+static std::string cache_name(memory_stream const& png, int format, bool premultiply) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (char const* it = png.address(), *end = it + png.size(); it != end; ++it)
+        hash = (hash ^ (uint8_t)*it) * 1099511628211ULL;
+
+    char name[40];
+    snprintf(name, sizeof(name), "%016llx_%d%s.c3tx", (unsigned long long)hash, format, premultiply ? "p" : "");
+    return name;
+}
+
+static int texture_color(int format) {
+    switch (format) {
+        case image_desc::RGB565: return texture::RGB565;
+        case image_desc::RGBA4444: return texture::RGBA4444;
+        case image_desc::A8: return texture::ALPHA;
+        default: return texture::RGBA8888;
+    }
+}
+
+png_loader::png_loader(render_device* rd, int format, bool premultiply)
+: _device(rd), _format(format), _premultiply(premultiply) {
 }
 
 png_loader::~png_loader() {
@@ -177,26 +173,96 @@ bool png_loader::can_load(data_stream *ds) const {
 }
 
 asset_handle::ptr png_loader::load(data_stream::ptr &&stream) const {
-    data_stream* ds = stream.release();
+    // the stream stays for reloading, the image in between the preparing
+    // (worker threads) and the loading (main thread)
+    struct decoding {
+        data_stream::ptr stream;
+        std::unique_ptr<image_data> image;
+        raw_texture::ptr raw;   // cached, with all the mip levels
+    };
+    std::shared_ptr<decoding> state(new decoding{std::move(stream), nullptr, nullptr});
     render_device* rd = _device;
+    int format = _format;
+    bool premultiply = _premultiply;
+    std::string cache_dir = _cache_dir;
+
+    // nothing shared but the state, safe on the worker threads
+    auto decode = [state, format, premultiply, cache_dir] () {
+        if (state->image || state->raw)
+            return;
+
+        int color = texture_color(format);
+        state->stream->seek(0, data_stream::SeekSet);
+
+        std::string cached;
+        memory_stream::ptr png;
+        if (!cache_dir.empty()) {
+            // the memory (mapped) streams are hashed in place
+            auto* mem = dynamic_cast<memory_stream*>(state->stream.get());
+            png.reset(mem != nullptr
+                      ? new memory_stream(mem->address(), mem->size(), false)
+                      : new memory_stream(state->stream.get()));
+            cached = cache_dir + '/' + cache_name(*png, format, premultiply);
+
+            struct stat st;
+            if (stat(cached.c_str(), &st) == 0) {
+                auto mapped = mapped_stream::open(cached.c_str());
+                if (mapped && (state->raw = raw_texture::from(std::move(mapped))) &&
+                    state->raw->color() == color)
+                    return;
+                state->raw.reset();
+            }
+        }
+
+        std::unique_ptr<image_data> img(new image_data());
+        img->desc.format = format;
+        bool has_alpha = false;
+        load_png(png ? *png : *state->stream, *img, premultiply, has_alpha);
+        if (!img->buffer) {
+            state->image = std::move(img);
+            return;
+        }
+
+        // all the levels built once and saved for the next time
+        uint8_t const* rgba = (uint8_t const*)img->buffer.get();
+        if (!cached.empty()) {
+            state->raw = raw_texture::build(rgba, img->desc.size, color, true, !has_alpha);
+            if (state->raw) {
+                state->raw->save(cached);
+                return;
+            }
+        }
+
+        if (color != texture::RGBA8888) {
+            size_t count = (size_t)img->desc.size.x() * img->desc.size.y();
+            img->buffer = raw_texture::convert(rgba, count, color, !has_alpha, img->buf_size);
+        }
+        state->image = std::move(img);
+    };
 
     return asset_handle::ptr(new texture_handle([=] (texture::ptr& tex, asset_collection&) {
-        data_stream::ptr stream(ds);
-        image_data img;
-
-        // TODO: auto detect the image type and load (A8/RGB565/RGBA8888)
-        load_png(*ds, img);
-
-        tex = rd->create_texture(img.desc.size,{
-            texture::T2D, texture::RGBA8888,
+        decode();   // unless prepared
+        raw_texture::ptr raw(std::move(state->raw));
+        if (raw) {
+            tex = raw->upload(rd);
+            return;
+        }
+
+        std::unique_ptr<image_data> img(std::move(state->image));
+        if (!img->buffer)
+            return;
+
+        int color = texture_color(img->desc.format);
+        tex = rd->create_texture(img->desc.size,{
+            texture::T2D, color,
             texture::Clamp, texture::Clamp,
             texture::NearestLinear, texture::Nearest,
             1
         });
-        tex->load(img.data().get(), texture::RGBA8888);
+        tex->load(img->data().get(), color);
 
         // auto-fill all the mipmaps for png textures
         tex->generate_mipmap();
-    }));
+    }, decode));
 
 }
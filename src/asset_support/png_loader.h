@@ -3,7 +3,9 @@
 
 #include "common/referenced_count.h"
 #include "asset/asset_loader.h"
+#include "common/utility.h"
 #include <memory>
+#include <string>
 
 class memory_stream;
 class render_device;
@@ -11,7 +13,7 @@ class render_device;
 // TODO: move this up
 struct image_desc {
     typedef Eigen::Vector2i vector2i;
-    enum { RGB565, RGBA8888, A8 }; // TODO: probably will support 4-bit channel
+    enum { RGB565, RGBA8888, A8, RGBA4444 };
     
     vector2i size;
     int format;
@@ -41,7 +43,10 @@ public:
         return ptr(new png_loader(rd));
     }
     
-    png_loader(render_device*);
+    /// the images are converted to the format (image_desc), the colors
+    /// are multiplied by the alpha if premultiply; A8 takes the alpha
+    /// channel, or the luminance if the image has no alpha
+    png_loader(render_device*, int format = image_desc::RGBA8888, bool premultiply = false);
     
     ~png_loader();
 
@@ -51,10 +56,15 @@ public:
 
     // TODO:
     // 1. the original image info
-    // 2. load image in a separate step for more controls
 
 private:
     render_device* _device = nullptr; // device to create textures
+    int _format;
+    bool _premultiply;
+
+    /// the decoded textures with the mip levels are cached in the dir
+    /// (see raw_texture) by the content, none if it's empty
+    ATTRIBUTE(std::string, cache_dir, std::string());
 };
 
 #endif
@@ -0,0 +1,246 @@
+#include "asset_support/raw_texture.h"
+#include "asset_support/pixel_convert.h"
+#include "asset_support/texture_asset.h"
+#include "re/render_device.h"
+#include "common/log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+INHERIT_LOGGER(raw_texture, data_stream);
+
+namespace {
+    // bits per pixel, 0 for the compressed ones
+    uint32_t bits_of(uint32_t color) {
+        switch (color) {
+            case texture::RGBA8888: return 32;
+            case texture::RGB565:
+            case texture::RGBA4444: return 16;
+            case texture::ALPHA:
+            case texture::LUMINANCE: return 8;
+            default: return 0;
+        }
+    }
+
+    uint32_t align(uint32_t offset) {
+        return (offset + raw_texture::Alignment - 1) & ~(raw_texture::Alignment - 1);
+    }
+
+    // the next level, 2x2 box filtered, the odd edge is clamped
+    void half_size(uint8_t const* src, int width, int height, uint8_t* dst) {
+        int w = std::max(width / 2, 1), h = std::max(height / 2, 1);
+        for (int y = 0; y < h; ++y) {
+            uint8_t const* row0 = src + (size_t)std::min(y * 2, height - 1) * width * 4;
+            uint8_t const* row1 = src + (size_t)std::min(y * 2 + 1, height - 1) * width * 4;
+            for (int x = 0; x < w; ++x, dst += 4) {
+                int x0 = std::min(x * 2, width - 1) * 4, x1 = std::min(x * 2 + 1, width - 1) * 4;
+                for (int c = 0; c < 4; ++c)
+                    dst[c] = (uint8_t)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+            }
+        }
+    }
+}
+
+#pragma mark - raw texture
+
+raw_texture::raw_texture(std::unique_ptr<memory_stream>&& stream)
+: _stream(std::move(stream)) {
+}
+
+raw_texture::ptr raw_texture::from(std::unique_ptr<memory_stream>&& stream) {
+    ptr raw(new raw_texture(std::move(stream)));
+    return raw->validate() ? std::move(raw) : nullptr;
+}
+
+bool raw_texture::validate() const {
+    size_t size = _stream->size();
+    if (size < sizeof(raw_texture_header) || memcmp(header().magic, "C3TX", 4) != 0 ||
+        header().version != raw_texture_header::Version) {
+        LOG_ERROR("not a texture container");
+        return false;
+    }
+
+    auto& h = header();
+    if (h.color > texture::RGBA4444 || h.width == 0 || h.height == 0 ||
+        h.levels == 0 || h.levels > raw_texture_header::MaxLevels) {
+        LOG_ERROR("corrupted texture container");
+        return false;
+    }
+
+    uint32_t bits = bits_of(h.color);
+    for (uint32_t i = 0; i < h.levels; ++i) {
+        auto& level = h.level[i];
+        uint64_t expected = (uint64_t)std::max(h.width >> i, 1U) * std::max(h.height >> i, 1U) * bits / 8;
+        if ((uint64_t)level.offset + level.size > size || (bits != 0 && level.size != expected)) {
+            LOG_ERROR("corrupted texture level: " << i);
+            return false;
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<char []> raw_texture::convert(uint8_t const* rgba, size_t count, int color,
+                                              bool luminance, size_t& size) {
+    size = count * bits_of(color) / 8;
+    std::unique_ptr<char []> out(size > 0 ? new char [size] : nullptr);
+    switch (color) {
+        case texture::RGBA8888:
+            memcpy(out.get(), rgba, size);
+            break;
+        case texture::RGB565:
+            pixel::to_rgb565(rgba, (uint16_t*)out.get(), count);
+            break;
+        case texture::RGBA4444:
+            pixel::to_rgba4444(rgba, (uint16_t*)out.get(), count);
+            break;
+        case texture::ALPHA:
+            if (luminance)
+                pixel::to_luminance(rgba, (uint8_t*)out.get(), count);
+            else
+                pixel::to_alpha(rgba, (uint8_t*)out.get(), count);
+            break;
+        case texture::LUMINANCE:
+            pixel::to_luminance(rgba, (uint8_t*)out.get(), count);
+            break;
+        default:
+            LOG_ERROR(raw_texture, "unable to convert to the color: " << color);
+            size = 0;
+            return nullptr;
+    }
+    return out;
+}
+
+raw_texture::ptr raw_texture::build(uint8_t const* rgba, texture::vector2i const& size, int color,
+                                    bool mipmaps, bool luminance) {
+    uint32_t bits = bits_of(color);
+    if (bits == 0 || size.x() <= 0 || size.y() <= 0) {
+        LOG_ERROR(raw_texture, "unable to build the texture: " << color);
+        return nullptr;
+    }
+
+    raw_texture_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "C3TX", 4);
+    header.version = raw_texture_header::Version;
+    header.color = color;
+    header.width = size.x();
+    header.height = size.y();
+
+    // the layout first, all the levels down to 1x1
+    uint32_t offset = align(sizeof(header));
+    for (uint32_t w = header.width, h = header.height; header.levels < raw_texture_header::MaxLevels;
+         w = std::max(w / 2, 1U), h = std::max(h / 2, 1U)) {
+        auto& level = header.level[header.levels++];
+        level.offset = offset;
+        level.size = w * h * bits / 8;
+        offset = align(offset + level.size);
+        if (!mipmaps || (w == 1 && h == 1))
+            break;
+    }
+
+    memory_stream::ptr stream(new memory_stream((size_t)offset));
+    char* base = stream->address();
+    memset(base, 0, offset);
+    memcpy(base, &header, sizeof(header));
+
+    // filter the RGBA8888 level by level, then convert
+    std::vector<uint8_t> current(rgba, rgba + (size_t)header.width * header.height * 4), next;
+    int w = header.width, h = header.height;
+    for (uint32_t i = 0; i < header.levels; ++i) {
+        if (i > 0) {
+            next.resize((size_t)std::max(w / 2, 1) * std::max(h / 2, 1) * 4);
+            half_size(current.data(), w, h, next.data());
+            current.swap(next);
+            w = std::max(w / 2, 1), h = std::max(h / 2, 1);
+        }
+
+        size_t level_size;
+        auto pixels = convert(current.data(), (size_t)w * h, color, luminance, level_size);
+        assert(level_size == header.level[i].size);
+        memcpy(base + header.level[i].offset, pixels.get(), level_size);
+    }
+
+    return ptr(new raw_texture(std::move(stream)));
+}
+
+texture::ptr raw_texture::upload(render_device* device) const {
+    auto& h = header();
+    texture::ptr tex = device->create_texture(size(), {
+        texture::T2D, (int)h.color,
+        texture::Clamp, texture::Clamp,
+        h.levels > 1 ? texture::NearestLinear : texture::Linear, texture::Nearest,
+        (int)h.levels
+    });
+
+    for (uint32_t i = 0; i < h.levels; ++i) {
+        // a view of the level, no copying
+        memory_stream level(_stream->address() + h.level[i].offset, h.level[i].size, false);
+        tex->load(&level, h.color, i);
+    }
+    return tex;
+}
+
+bool raw_texture::save(std::string const& filename) const {
+    // the other readers see either the whole or none
+    std::string temp = filename + ".tmp";
+    FILE* fp = fopen(temp.c_str(), "wb");
+    if (fp == nullptr) {
+        LOG_WARN("unable to write the texture: " << filename);
+        return false;
+    }
+
+    bool ok = fwrite(_stream->address(), 1, _stream->size(), fp) == _stream->size();
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(temp.c_str(), filename.c_str()) != 0) {
+        LOG_WARN("unable to write the texture: " << filename);
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+#pragma mark - raw texture loader
+
+raw_texture_loader::raw_texture_loader(render_device* rd) : _device(rd) {
+}
+
+bool raw_texture_loader::can_load(data_stream* ds) const {
+    char magic[4];
+
+    auto cur = ds->tell();
+    bool can = ds->read(magic, 4) == 4 && memcmp(magic, "C3TX", 4) == 0;
+
+    ds->seek(cur, data_stream::SeekSet);
+    return can;
+}
+
+asset_handle::ptr raw_texture_loader::load(data_stream::ptr&& stream) const {
+    struct loading {
+        data_stream::ptr stream;
+        raw_texture::ptr raw;
+    };
+    std::shared_ptr<loading> state(new loading{std::move(stream), nullptr});
+    render_device* rd = _device;
+
+    // the memory (mapped) streams are used in place, the others are read
+    auto prepare = [state] () {
+        if (state->raw)
+            return;
+
+        state->stream->seek(0, data_stream::SeekSet);
+        auto* mem = dynamic_cast<memory_stream*>(state->stream.get());
+        memory_stream::ptr data(mem != nullptr
+                                ? new memory_stream(mem->address(), mem->size(), false)
+                                : new memory_stream(state->stream.get()));
+        state->raw = raw_texture::from(std::move(data));
+    };
+
+    return asset_handle::ptr(new texture_handle([=] (texture::ptr& tex, asset_collection&) {
+        prepare();  // unless prepared
+        raw_texture::ptr raw(std::move(state->raw));
+        if (raw)
+            tex = raw->upload(rd);
+    }, prepare));
+}
@@ -0,0 +1,87 @@
+#ifndef _CHAOS3D_ASSET_SUPPORT_RAW_TEXTURE_H
+#define _CHAOS3D_ASSET_SUPPORT_RAW_TEXTURE_H
+
+#include "asset/asset_loader.h"
+#include "io/memory_stream.h"
+#include "re/texture.h"
+#include <cstdint>
+
+class render_device;
+
+/// the header of the texture container (.c3tx), little endian, the
+/// levels are aligned to raw_texture::Alignment
+struct raw_texture_header {
+    enum { Version = 1, MaxLevels = 16 };
+
+    struct level_t {
+        uint32_t offset;        // from the beginning
+        uint32_t size;
+    };
+
+    char magic[4];              // "C3TX"
+    uint32_t version;
+    uint32_t color;             // texture::RGBA8888...
+    uint32_t width, height;
+    uint32_t levels;
+    level_t level[MaxLevels];
+};
+
+/// the engine texture container
+///
+/// the pixels are in the final color format with all the mip levels, so
+/// they're uploaded as they are, no decoding nor generating the mipmaps.
+/// the compressed payloads (PVRTC) are made offline, the cache of the
+/// png_loader writes the uncompressed ones.
+class raw_texture {
+public:
+    typedef std::unique_ptr<raw_texture> ptr;
+
+    enum { Alignment = 16 };
+
+public:
+    /// the container in the memory (i.e. mapped), null if it's not valid
+    static ptr from(std::unique_ptr<memory_stream>&&);
+
+    /// build from the RGBA8888 pixels, the mip levels are box filtered
+    /// down to 1x1 if mipmaps; the alpha is the luminance if luminance
+    static ptr build(uint8_t const* rgba, texture::vector2i const& size, int color,
+                     bool mipmaps, bool luminance = false);
+
+    /// convert the RGBA8888 pixels to the uncompressed color, null if the
+    /// color isn't supported
+    static std::unique_ptr<char []> convert(uint8_t const* rgba, size_t count, int color,
+                                            bool luminance, size_t& size);
+
+    texture::vector2i size() const { return {(int)header().width, (int)header().height}; }
+    int color() const { return header().color; }
+    int levels() const { return header().levels; }
+
+    /// create the texture and upload all the levels
+    texture::ptr upload(render_device*) const;
+
+    /// write it as it is, replaced at once
+    bool save(std::string const& filename) const;
+
+private:
+    raw_texture(std::unique_ptr<memory_stream>&&);
+
+    raw_texture_header const& header() const { return *(raw_texture_header const*)_stream->address(); }
+    bool validate() const;
+
+    std::unique_ptr<memory_stream> _stream;
+};
+
+/// loads the texture containers
+class raw_texture_loader : public asset_loader {
+public:
+    raw_texture_loader(render_device*);
+
+    virtual bool can_load(data_stream*) const override;
+
+    virtual asset_handle::ptr load(data_stream::ptr&&) const override;
+
+private:
+    render_device* _device = nullptr;
+};
+
+#endif
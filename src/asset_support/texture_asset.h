@@ -11,10 +11,23 @@ public:
     typedef functor_asset_handle<texture> base_t;
     
 public:
-    asset_handle_base(loader_t const& loader)
-    : base_t(loader) {
+    asset_handle_base(loader_t const& loader, preparer_t const& preparer = nullptr)
+    : base_t(loader, preparer) {
     }
     
+    virtual cost_t cost() const override {
+        // a third more for the mipmaps, which are always generated for now
+        return {0, is_loaded() ? _asset_ptr->memory_size() * 4 / 3 : 0};
+    }
+
+protected:
+    virtual void replace(ptr_t&& asset) override {
+        // into the same texture, the materials and atlases see it
+        _asset_ptr->swap(*asset);
+    }
+
+public:
+    
     // TODO: load from a meta config
 };
 
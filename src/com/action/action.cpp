@@ -1,4 +1,5 @@
 #include "com/action/action.h"
+#include <algorithm>
 
 namespace com {
     action::action(game_object* go)
@@ -26,17 +27,18 @@ namespace com {
 
     action_mgr& action_mgr::add_action(com::action* act) {
         act->get_action()->start(); // the parent action is always active
-        _actions.emplace_front(act);
+        _actions.emplace_back(act);
         return *this;
     }
     
     void action_mgr::pre_update(const goes_t &) {
-        _actions.remove_if([] (action_ptr const& act) {
+        _actions.erase(std::remove_if(_actions.begin(), _actions.end(), [] (action_ptr const& act) {
             return act->_mark_for_remove;
-        });
+        }), _actions.end());
         
-        for (auto& it : _actions) {
-            it->get_action()->update();
+        // new actions can be added during the update, so by index
+        for (size_t i = 0; i < _actions.size(); ++i) {
+            _actions[i]->get_action()->update();
         }
     }
 }
\ No newline at end of file
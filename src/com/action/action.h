@@ -4,7 +4,6 @@
 #include "go/component.h"
 #include "action/action.h"
 #include <vector>
-#include <forward_list>
 
 namespace com {
     class action_mgr;
@@ -39,7 +38,7 @@ namespace com {
     public:
         typedef std::false_type component_fixed_t;
         typedef std::unique_ptr<action> action_ptr;
-        typedef std::forward_list<action_ptr> actions_t;
+        typedef std::vector<action_ptr> actions_t;     // flat, updated in order
         
     protected:
         /// to add the action to the managed list
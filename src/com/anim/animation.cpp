@@ -2,15 +2,13 @@
 #include "sg/transform.h"
 #include "go/game_object.h"
 #include "com/anim/animation.h"
-#include "loader/json/json_loader.h"
 #include "com/sprite2d/quad_sprite.h"
+#include "com/render/camera.h"
 #include "action_support/action_animation.h"
 #include <forward_list>
-#include <rapidjson/document.h>
+#include <algorithm>
 
 using namespace com;
-using namespace rapidjson; // TODO: move this out of this scope
-typedef rapidjson::GenericValue<rapidjson::UTF8<char>> json_value_t;
 
 #define QUATERNION_Z(r) quaternionf(Eigen::AngleAxisf(r*M_PI/180.f, vector3f::UnitZ()))
 
@@ -24,201 +22,148 @@ animation::animation(game_object* go, data_stream* ds,
     animation_mgr::instance().add_animation(this);
 }
 
+animation::animation(game_object* go, skeleton const* skel, int32_t idx)
+: component(go), _start_index(idx) {
+    set_skeleton(skel);
+    animation_mgr::instance().add_animation(this);
+}
+
 animation& animation::operator=(animation const& rhs) {
     // TODO
     return *this;
 }
 
+act::action_animation& animation::controller() {
+    if (!_action) {
+        _action.reset(new act::action_animation(this));
+        _action->start();
+    }
+    return static_cast<act::action_animation&>(*_action);
+}
+
 ::action::ptr animation::make_action(const std::string &clip_name) const {
-    auto it = _clips.find(clip_name);
-    if (it == _clips.end()) {
+    auto const* clip = _skeleton ? _skeleton->find_clip(clip_name) : nullptr;
+    if (clip == nullptr) {
         LOG_WARN("animation clip couldn't be found: " << clip_name);
         return nullptr;
     }
     
-    auto* anim = new act::action_animation(it->second, this);
+    auto* anim = new act::action_animation(*clip, this);
     return ::action::ptr(anim);
 }
 
 void animation::play(const std::string &name) {
-    _action = std::move(make_action(name));
-    if (_action) {
-        _action->start();
-    }
+    play_layer(0, name, 0.f);
 }
 
-void animation::clear() {
-    // TODO:
+void animation::crossfade(std::string const& name, float duration) {
+    play_layer(0, name, duration);
 }
 
-template<typename C>
-void animation::load_skin(const std::string &name, C const& value) {
-    LOG_INFO("skin : " << typeid(C).name());
-    auto skin_ret = _skins.emplace(name, skin_t());
-    if (!skin_ret.second) {
-        LOG_WARN("the skin is dup, skipped: " << name);
+void animation::play_layer(uint32_t layer, std::string const& name, float fade) {
+    auto const* clip = _skeleton ? _skeleton->find_clip(name) : nullptr;
+    if (clip == nullptr) {
+        LOG_WARN("animation clip couldn't be found: " << name);
         return;
     }
     
-    auto& skin = skin_ret.first->second;
-    for (auto itr = value.MemberBegin(); itr != value.MemberEnd(); ++itr) {
-        // slot name is ignored. TODO: preprocessor to reorg the data
-        
-        for (auto sprite_it = itr->value.MemberBegin();
-             sprite_it != itr->value.MemberEnd(); ++sprite_it) {
-            auto* name = sprite_it->name.GetString();
-            double rotation = 0.f;
-            box2f bound;
-            vector3f translate;
-            
-            for (auto attr = sprite_it->value.MemberBegin();
-                 attr != sprite_it->value.MemberEnd(); ++attr) {
-                if (strcmp(attr->name.GetString(), "name") == 0) {
-                    name = attr->value.GetString();
-                } else if (strcmp(attr->name.GetString(), "x") == 0) {
-                    translate.x() = attr->value.GetDouble();
-                } else if (strcmp(attr->name.GetString(), "y") == 0) {
-                    translate.y() = attr->value.GetDouble();
-                } else if (strcmp(attr->name.GetString(), "width") == 0) {
-                    bound.min().x() = -attr->value.GetDouble() / 2.0;
-                    bound.max().x() = attr->value.GetDouble() / 2.0;
-                } else if (strcmp(attr->name.GetString(), "height") == 0) {
-                    bound.min().y() = -attr->value.GetDouble() / 2.0;
-                    bound.max().y() = attr->value.GetDouble() / 2.0;
-                } else if (strcmp(attr->name.GetString(), "rotation") == 0) {
-                    rotation = attr->value.GetDouble();
-                }
-            }
-            
-            skin.emplace(std::piecewise_construct,
-                         std::forward_as_tuple(name),
-                         std::forward_as_tuple(skin_piece{nullptr, bound, translate, rotation}));
+    controller().play(*clip, layer, fade);
+}
+
+void animation::set_layer_weight(uint32_t layer, float weight) {
+    controller().set_layer_weight(layer, weight);
+}
+
+void animation::set_layer_mask(uint32_t layer, std::vector<std::string> const& joints) {
+    act::action_animation::mask_t mask(_transforms.size(), 0.f);
+    for (auto& name : joints) {
+        auto it = names().find(name);
+        if (it == names().end()) {
+            LOG_WARN("the joint is not defined, ignored: " << name);
+            continue;
         }
         
+        auto const* joint = _transforms[it->second]->parent();
+        for (size_t i = 0; i < _transforms.size(); ++i) {
+            if (_transforms[i]->parent()->is_descendant_of(joint))
+                mask[i] = 1.f;
+        }
     }
+    controller().set_layer_mask(layer, mask);
 }
 
-bool animation::load_from(data_stream *ds, std::vector<texture_atlas*> const& atlases) {
-    if (ds == nullptr || !ds->valid()) {
-        LOG_WARN("the stream is not ready, ignore loading");
-        return false;
-    }
-    
-    clear();
-    
-    game_object* root = parent();
+void animation::set_active(bool active) {
+    if (_active == active)
+        return;
     
-    json_document doc(ds);
-    auto& json = doc.internal<rapidjson::Document>();
-    auto& joints = json["bones"];
-    size_t idx = 0;
-    if (joints.IsArray()) {
-        for (auto it = joints.Begin(); it != joints.End(); ++it, ++idx) {
-            auto* name = (*it)["name"].GetString();
-            size_t parent_idx = SIZE_T_MAX;
-            double x = 0.f, y = 0.f, scaleX = 1.f, scaleY = 1.f;
-            double rotate = 0.f;
-            _names.emplace(std::piecewise_construct,
-                           std::forward_as_tuple(name),
-                           std::forward_as_tuple(idx));
-            auto* go = new game_object(root, name);
+    _active = active;
+    animation_mgr::instance().invalidate_active();
+}
 
-            for (auto itr = it->MemberBegin(); itr != it->MemberEnd(); ++itr) {
-                if (strcmp(itr->name.GetString(), "x") == 0) {
-                    x = itr->value.GetDouble();
-                } else if (strcmp(itr->name.GetString(), "y") == 0) {
-                    y = itr->value.GetDouble();
-                } else if (strcmp(itr->name.GetString(), "scaleX") == 0) {
-                    scaleX = itr->value.GetDouble();
-                } else if (strcmp(itr->name.GetString(), "scaleY") == 0) {
-                    scaleY = itr->value.GetDouble();
-                } else if (strcmp(itr->name.GetString(), "rotation") == 0) {
-                    rotate = itr->value.GetDouble();
-                } else if (strcmp(itr->name.GetString(), "parent") == 0) {
-                    auto pid = _names.find(std::string(itr->value.GetString()));
-                    if (pid != _names.end()) {
-                        parent_idx = pid->second;
-                    } else {
-                        LOG_WARN("parent joint is not defined yet: " << itr->value.GetString());
-                    }
-                }
-            }
-            _transforms.emplace_back(&go->add_component<com::transform>(vector3f(x, y, 0.f),
-                                                                        QUATERNION_Z(rotate),
-                                                                        vector3f(scaleX, scaleY, 1.f)));
-            _setup_poses.emplace_back(joint_pose{
-                vector3f(x, y, 0.f),
-                vector3f(scaleX, scaleY, 1.f),
-                QUATERNION_Z(rotate)
-            });
-            if (parent_idx != SIZE_T_MAX) {
-                _transforms[parent_idx]->parent()->add_child(_transforms.back()->parent());
-            }
-        }
-    }
-    
-    auto& skins = json["skins"];
-    std::string default_skin;
-    if (skins.IsObject()) {
-        for (auto it = skins.MemberBegin(); it != skins.MemberEnd(); ++it) {
-            load_skin(it->name.GetString(), it->value);
-        }
-        // if loaded any skin, set the first one to be default and load afterwards
-        if (!_skins.empty()) {
-            default_skin = skins.MemberBegin()->name.GetString();
-        }
-    }
+void animation::clear() {
+    // the playing clips belong to the old skeleton
+    _action.reset();
     
-    for (auto& atlas : atlases) {
-        add_atlas(atlas);
-    }
+    // removing the root joints takes all the others
+    parent()->remove_if([this] (game_object const& go) {
+        return std::any_of(_transforms.begin(), _transforms.end(), [&go] (transform const* t) {
+            return t->parent() == &go;
+        });
+    });
+    _transforms.clear();
+}
+
+bool animation::load_from(data_stream *ds, std::vector<texture_atlas*> const& atlases) {
+    auto skel = skeleton::load_from(ds, atlases);
+    if (!skel)
+        return false;
     
-    auto& slots = json["slots"];
-    if (slots.IsArray()) {
-        int32_t index = start_index();
-        for (auto it = slots.Begin(); it != slots.End(); ++it) {
-            auto* name = (*it)["name"].GetString();
-            std::string joint = (*it)["bone"].GetString();
-            auto jit = _names.find(joint);
-            if (jit == _names.end()) {
-                LOG_WARN("the joint is not defined, ignored: " << joint);
-                continue;
-            }
-            auto& attachement = (*it)["attachment"];
-            char const* piece_name = "";
-            
-            if (attachement.IsString()) {
-                piece_name = attachement.GetString();
-            }
+    set_skeleton(skel.get());
+    return true;
+}
 
-            _slots.emplace(std::piecewise_construct,
-                           std::forward_as_tuple(name),
-                           std::forward_as_tuple(jit->second, ++index, piece_name));
-        }
+void animation::set_skeleton(skeleton const* skel) {
+    clear();
+    _skeleton = skel ? skel->retain<skeleton>() : nullptr;
+    if (_skeleton) {
+        create_joints();
     }
+}
 
-    auto& animations = json["animations"];
-    if (animations.IsObject()) {
-        for (auto anim = animations.MemberBegin();
-             anim != animations.MemberEnd(); ++anim) {
-            
-            _clips.emplace(std::piecewise_construct,
-                           std::forward_as_tuple(anim->name.GetString()),
-                           std::forward_as_tuple(animation_clip::load_from(anim->value)));
+void animation::create_joints() {
+    auto const& poses = _skeleton->setup_poses();
+    auto const& parents = _skeleton->parents();
+    std::vector<char const*> names(poses.size(), "");
+    for (auto& it : _skeleton->names())
+        names[it.second] = it.first.c_str();
+    
+    _transforms.reserve(poses.size());
+    for (size_t i = 0; i < poses.size(); ++i) {
+        auto* go = new game_object(parent(), names[i]);
+        _transforms.emplace_back(&go->add_component<com::transform>(poses[i].translate,
+                                                                    poses[i].rotate,
+                                                                    poses[i].scale));
+        if (parents[i] >= 0) {
+            _transforms[parents[i]]->parent()->add_child(go);
         }
     }
     
     // apply the default skin if any
-    if (!default_skin.empty()) {
-        apply_skin(default_skin);
+    if (!_skeleton->default_skin().empty()) {
+        apply_skin(_skeleton->default_skin());
     }
+}
 
-    return true;
+bool animation::save_binary(std::vector<char>& blob) const {
+    return _skeleton && _skeleton->save_binary(blob);
 }
 
 bool animation::apply_skin(std::string const& name) {
-    auto skin = _skins.find(name);
-    if (skin == _skins.end()) {
+    if (!_skeleton)
+        return false;
+    
+    auto skin = _skeleton->skins().find(name);
+    if (skin == _skeleton->skins().end()) {
         LOG_WARN("the skin name is not found: " << name);
         return false;
     }
@@ -231,7 +176,7 @@ bool animation::apply_skin(std::string const& name) {
         });
     }
     
-    for (auto& slot : _slots) {
+    for (auto& slot : _skeleton->slots()) {
         auto* joint = _transforms[slot.second.joint_index]->parent();
         
         game_object* go = new game_object(joint);
@@ -241,11 +186,12 @@ bool animation::apply_skin(std::string const& name) {
             continue;
         
         auto piece = skin->second.find(slot.second.piece_name);
-        if (piece != skin->second.end() && piece->second.atlas) {
+        auto* atlas = piece != skin->second.end() ? piece_atlas(piece->first, piece->second) : nullptr;
+        if (atlas != nullptr) {
             auto* tf = go->get_component<com::transform>();
-            auto& sp = go->add_component<sprite2d::quad_sprite>(*piece->second.atlas,
+            auto& sp = go->add_component<sprite2d::quad_sprite>(*atlas,
                                                                 piece->first); // TODO: use default material
-            sp.set_index(slot.second.sprite_index);
+            sp.set_index(start_index() + slot.second.sprite_index);
             
             // FIXME: default bound if omitted
             sp.set_bound_from_box(piece->second.bound);
@@ -259,13 +205,18 @@ bool animation::apply_skin(std::string const& name) {
 }
 
 void animation::add_atlas(texture_atlas* atlas) {
-    for (auto& skin : _skins) {
-        for (auto& piece : skin.second) {
-            if (atlas->has_frame(piece.first)) {
-                piece.second.atlas = atlas;
-            }
-        }
+    // the skeleton is shared, the atlases are kept by the instance
+    if (atlas != nullptr)
+        _atlases.push_back(atlas);
+}
+
+texture_atlas* animation::piece_atlas(std::string const& name, skeleton::skin_piece const& piece) const {
+    // the later added ones first
+    for (auto it = _atlases.rbegin(); it != _atlases.rend(); ++it) {
+        if ((*it)->has_frame(name))
+            return *it;
     }
+    return piece.atlas;
 }
 
 void animation::destroy() {
@@ -276,17 +227,94 @@ void animation::destroy() {
 #pragma mark - animation mgr
 
 void animation_mgr::add_animation(animation* anim) {
+    anim->_lod_phase = _phase++;
     _animations.emplace_front(anim);
+    invalidate_active();
+}
+
+animation_mgr::lod_policy_t animation_mgr::camera_lod(camera const* cam, float distance,
+                                                      uint32_t rate, float margin) {
+    // the camera is found by a weak handle of its object each time, not
+    // to be kept (nor dangling) by the policy
+    typedef referenced_count::weak_ref_ctrl<game_object> weak_t;
+    std::shared_ptr<weak_t> weak(cam->parent()->get<game_object>().release(),
+                                 referenced_count::weak_ref_ctrl_base::weak_releaser());
+    
+    return [=] (animation const& anim) -> uint32_t {
+        // every frame once the camera is gone
+        auto* go = weak->expired() ? nullptr : static_cast<game_object*>(weak->raw_pointer());
+        auto* view = go != nullptr ? go->get_component<camera>() : nullptr;
+        auto* trans = anim.parent()->get_component<com::transform>();
+        if (!view || !trans)
+            return 1;
+        
+        vector3f pos = trans->global_affine().translation();
+        if (!view->in_view(pos, margin))
+            return 0;
+        
+        auto* cam_trans = go->get_component<com::transform>();
+        vector3f eye = cam_trans ? vector3f(cam_trans->global_affine().translation()) : vector3f::Zero();
+        return (pos - eye).squaredNorm() > distance * distance ? rate : 1;
+    };
 }
 
 void animation_mgr::pre_update(const goes_t &) {
-    _animations.remove_if([] (animation_ptr const& anim) {
+    _animations.remove_if([this] (animation_ptr const& anim) {
+        if (anim->_mark_for_remove)
+            _active_dirty = true;
         return anim->_mark_for_remove;
     });
     
-    // FIXME: don't update deactivated game objects
-    for (auto& it : _animations) {
-        if (it->_action)
+    // deactivated animations are not in the list at all
+    if (_active_dirty) {
+        _active.clear();
+        for (auto& it : _animations) {
+            if (it->_active)
+                _active.emplace_back(it.get());
+        }
+        _active_dirty = false;
+    }
+    
+    ++ _frame;
+    _batch.clear();
+    for (auto* it : _active) {
+        if (!it->_action)
+            continue;
+        
+        // skipped animations only advance the time (timer based), and
+        // resample when they update again
+        if (_lod_policy) {
+            auto rate = _lod_policy(*it);
+            if (rate == 0 || (_frame + it->_lod_phase) % rate != 0)
+                continue;
+        }
+        
+        // plain clip playbacks (no blending) can be sampled together
+        if (typeid(*it->_action) == typeid(act::action_animation) && it->_action->empty()
+            && static_cast<act::action_animation&>(*it->_action).plain_clip() != nullptr) {
+            _batch.emplace_back(static_cast<act::action_animation*>(it->_action.get()));
+        } else {
             it->_action->update();
+        }
+    }
+    
+    std::sort(_batch.begin(), _batch.end(), [] (act::action_animation const* lhs,
+                                                 act::action_animation const* rhs) {
+        return &lhs->clip() < &rhs->clip();
+    });
+    
+    for (auto first = _batch.begin(); first != _batch.end();) {
+        auto last = std::find_if(first, _batch.end(), [&] (act::action_animation const* anim) {
+            return &anim->clip() != &(*first)->clip();
+        });
+        
+        auto count = std::distance(first, last);
+        if (count >= clip_sampler::MinBatch) {
+            _sampler.sample((*first)->clip(), &*first, count);
+        } else {
+            for (; first != last; ++first)
+                static_cast< ::action*>(*first)->update();
+        }
+        first = last;
     }
 }
@@ -5,71 +5,74 @@
 #include "action/action.h"
 #include "io/data_stream.h"
 #include "com/anim/animation_clip.h"
+#include "com/anim/clip_sampler.h"
+#include "com/anim/skeleton.h"
 #include "com/sprite2d/texture_atlas.h"
 #include <unordered_map>
+#include <functional>
 #include <map>
 
+namespace act {
+    class action_animation;
+}
+
 namespace com {
     class transform;
+    class camera;
     class animation_mgr;
 
     /// the animation component, managing relationship between the animations
     /// and the game object.
     ///
     /// create and manage the children game objects, so the skeleton animation
-    /// can apply to the same structure (targeting)
-    /// ?? handle the state machine to fire off the animation action, which will
-    /// do the blending and updating
+    /// can apply to the same structure (targeting). the skeleton definition
+    /// and the clips are shared, each instance only owns its joints and the
+    /// playing states
+    /// the clips are played by the animation action, which does the
+    /// blending (cross fading, layers) and updating
     class animation : public component {
     public:
         typedef animation_mgr manager_t;
         
         // TODO: additive channels
         // TODO: other channels: i.e. events/uniform/skin/texture/particles
-        typedef std::unordered_map<std::string, animation_clip::ptr> clips_t;
-        typedef std::unordered_map<std::string, uint32_t> names_t;
+        typedef skeleton::names_t names_t;
+        typedef skeleton::joint_poses_t joint_poses_t;
+        typedef skeleton::joint_pose joint_pose;
         typedef std::vector<transform*> transforms_t;
-
-        // FIXME: better skin struct
-        // TODO: move this struct to a different class
-        struct skin_piece {
-            texture_atlas*  atlas;
-            box2f           bound;      // sprite bound
-            vector3f        translate;  // translate
-            double          rotation;
-        };
-        typedef std::unordered_map<std::string, skin_piece> skin_t;
-        typedef std::map<std::string, skin_t> skins_t;
-        
-        struct joint_pose {
-            vector3f translate;
-            vector3f scale;
-            quaternionf rotate;
-        };
-        typedef std::vector<joint_pose> joint_poses_t;
-        
-        struct slot {
-            uint32_t    joint_index;    // joint index in joint pose array
-            int32_t     sprite_index;   // sprite drawing index
-            std::string piece_name;     // skin piece name
-            
-            slot(uint32_t idx, int32_t sid, char const* name)
-            : joint_index(idx), sprite_index(sid), piece_name(name)
-            {}
-        };
-        typedef std::unordered_map<std::string, slot> slots_t;
         
     public:
-        /// load animation/skeleton data from the json stream
+        /// load animation/skeleton data from the stream
         animation(game_object*,
                   data_stream* = nullptr, std::vector<texture_atlas*> const& = {},
                   int32_t idx = 0);
+        
+        /// create the joints for the shared skeleton
+        animation(game_object*, skeleton const*, int32_t idx = 0);
 
         /// play the named animation
         void play(std::string const& name);
+        
+        /// fade from the playing animation to the named one in the duration
+        void crossfade(std::string const& name, float duration);
+        
+        /// play the named animation in the layer over the lower ones,
+        /// fading from the playing one in that layer
+        void play_layer(uint32_t layer, std::string const& name, float fade);
+        
+        /// the weight of the layer over the lower ones
+        void set_layer_weight(uint32_t layer, float weight);
+        
+        /// limit the layer to the named joints and their children
+        void set_layer_mask(uint32_t layer, std::vector<std::string> const& joints);
 
         //TODO: stop/pause, using the timer
         //void stop();
+        
+        /// deactivated animations are not updated at all, the time still
+        /// goes on so it will pick up the right pose once activated
+        void set_active(bool);
+        bool active() const { return _active; }
 
         /// create the action from the given clip name
         /// this is version 1 that each animation is separate and
@@ -78,42 +81,61 @@ namespace com {
         
         /// apply the skin to the object structure
         bool apply_skin(std::string const&);
-        void add_atlas(texture_atlas*); // fill the skins from the atlas, TODO: better API
+        
+        /// the atlas for the skin pieces of this instance, over the ones
+        /// the skeleton is loaded with; applied by the next apply_skin
+        void add_atlas(texture_atlas*);
         
         /// get all the bounding children
         transforms_t const& transforms() const { return _transforms; }
 
-        /// load the animation/skeleton data from the json stream
+        /// load the animation/skeleton data from the stream, either the
+        /// json or the precompiled binary (see skeleton_binary)
         bool load_from(data_stream*, std::vector<texture_atlas*> const& = {});
         
+        /// use the shared skeleton, re-creating the joints
+        void set_skeleton(skeleton const*);
+        
+        /// the shared skeleton data, or nullptr
+        skeleton const* skeleton_() const { return _skeleton.get(); }
+        
+        /// compile the skeleton to the binary blob, which loads much
+        /// faster than the json
+        bool save_binary(std::vector<char>&) const;
+        
         /// get the name to index mapping
-        names_t const& names() const { return _names; }
+        names_t const& names() const { return _skeleton->names(); }
         
         /// the initial setup poses for children
-        joint_poses_t const& setup_poses() const { return _setup_poses; }
+        joint_poses_t const& setup_poses() const { return _skeleton->setup_poses(); }
         
     private:
-        /// load skin, template to remove dependencies
-        template<typename C>
-        void load_skin(std::string const&, C const&);
+        /// the action to play and blend the clips, created on demand
+        act::action_animation& controller();
         
         /// remove all data, destroy all children/game objects
         void clear();
         
+        /// create the joint game objects from the skeleton
+        void create_joints();
+        
         virtual void destroy() override;
         animation& operator=(animation const& rhs);
         
+        /// the atlas of the piece, the instance's first
+        texture_atlas* piece_atlas(std::string const&, skeleton::skin_piece const&) const;
+        
+        skeleton::const_ptr _skeleton; // shared definition
         transforms_t _transforms;   // all children for the skeleton
-        joint_poses_t _setup_poses; // setup poses
-        names_t _names;             // joint names => joint index lookup
-        slots_t _slots;             // skin names => slot config
-        skins_t _skins;             // skins sets
-        clips_t _clips;             // animation clips
+        std::vector<texture_atlas*> _atlases; // added to this instance
         
         // flag for the manager to defer removing until the update
         bool _mark_for_remove = false;
+        
+        bool _active = true;
+        uint32_t _lod_phase = 0; // spread reduced updates across frames
 
-        // action root
+        // action root, an action_animation
         action::ptr _action;
         
         /// the starting index for the child sprites
@@ -129,16 +151,42 @@ namespace com {
         typedef std::false_type component_fixed_t;
         typedef std::unique_ptr<animation> animation_ptr;
         typedef std::forward_list<animation_ptr> animations_t;
+        typedef std::vector<act::action_animation*> batch_t;
+        typedef std::vector<animation*> active_t;
+        
+        /// the update rate policy: frames between two updates of the
+        /// animation, 1 to update every frame, 0 not to update (off-screen)
+        typedef std::function<uint32_t (animation const&)> lod_policy_t;
+        
+    public:
+        void set_lod_policy(lod_policy_t const& policy) { _lod_policy = policy; }
+        
+        /// a policy by the camera: the animations out of the view are not
+        /// updated; the ones farther than the distance update every 'rate'
+        /// frames. the margin extends the view for the skeleton size; all
+        /// update every frame once the camera (or its object) is gone
+        static lod_policy_t camera_lod(camera const*, float distance,
+                                       uint32_t rate, float margin = .2f);
         
     protected:
         // add the animation to be managed
         void add_animation(animation*);
         
+        // the active list needs rebuilding
+        void invalidate_active() { _active_dirty = true; }
+        
         virtual void pre_update(goes_t const&) override;
         virtual void update(goes_t const&) override {};
 
     private:
         animations_t _animations;
+        active_t _active;       // the animations to update
+        bool _active_dirty = true;
+        uint32_t _frame = 0;
+        uint32_t _phase = 0;
+        lod_policy_t _lod_policy;
+        batch_t _batch;         // clip playbacks, grouped by the clip
+        clip_sampler _sampler;  // to sample the same clip at once
 
         friend class animation;
     };
@@ -126,3 +126,29 @@ uint32_t animation_clip::get_channels(names_t const& names,
     return count;
 }
 
+
+uint32_t animation_clip::get_joints(names_t const& names,
+                                   joints_t& joints) const {
+    uint32_t count = 0;
+    joints.assign(_channels.size(), -1);
+    for (auto& name : names) {
+        auto idx = _names.find(name.first);
+        if (idx == _names.end())
+            continue;
+        
+        joints[idx->second] = name.second;
+        ++ count;
+    }
+    return count;
+}
+
+void animation_clip::compress(float translate, float scale, float rotate) {
+    for (auto& channel : _channels) {
+        if (channel->translate)
+            channel->translate->compress(translate);
+        if (channel->scale)
+            channel->scale->compress(scale);
+        if (channel->rotate)
+            channel->rotate->compress(rotate);
+    }
+}
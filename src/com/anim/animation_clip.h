@@ -60,6 +60,7 @@ namespace com {
         };
         
         typedef std::vector<clip_channel*> channels_t;
+        typedef std::vector<int32_t> joints_t;
         typedef std::unordered_map<std::string, uint32_t> names_t;
         typedef std::vector<clip_channel::ptr> clip_channels_t;
         
@@ -80,6 +81,22 @@ namespace com {
         /// @return number of channels is added
         uint32_t get_channels(names_t const&, channels_t&) const;
         
+        /// giving the names, fill the joint index for each channel of this
+        /// clip, or -1 if the channel has no joint
+        /// @return number of channels is bound
+        uint32_t get_joints(names_t const&, joints_t&) const;
+        
+        /// channel data in the clip order
+        clip_channels_t const& channels() const { return _channels; }
+        
+        /// the channel/joint name to channel index mapping
+        names_t const& names() const { return _names; }
+        
+        /// compress the translate/scale/rotate channels: the keys within the
+        /// tolerances (rotate in radians) are dropped and the rest are packed
+        /// to 16 bits, decoded when sampled
+        void compress(float translate, float scale, float rotate);
+        
     private:
         void load_from(data_stream*); // load and initialize data
         
@@ -0,0 +1,176 @@
+#include "com/anim/clip_sampler.h"
+#include "com/anim/animation.h"
+#include "action_support/action_animation.h"
+#include "sg/transform.h"
+
+using namespace com;
+
+void clip_sampler::sample(animation_clip const& clip, instance_t* const* instances, size_t count) {
+    if (count == 0)
+        return;
+
+    auto rows = (array1f_t::Index)count;
+    if (_progress.rows() < rows) {
+        _progress.resize(rows);
+        _from3.resize(rows, Eigen::NoChange);
+        _to3.resize(rows, Eigen::NoChange);
+        _setup3.resize(rows, Eigen::NoChange);
+        _from4.resize(rows, Eigen::NoChange);
+        _to4.resize(rows, Eigen::NoChange);
+        _setup4.resize(rows, Eigen::NoChange);
+    }
+
+    _offsets.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        assert(&instances[i]->clip() == &clip);
+        _offsets[i] = instances[i]->offset();
+    }
+
+    uint32_t idx = 0;
+    for (auto& channel : clip.channels()) {
+        if (channel->rotate)
+            sample_rotate(*channel->rotate, idx, instances, count);
+        if (channel->translate)
+            sample_translate(*channel->translate, idx, instances, count);
+        if (channel->scale)
+            sample_scale(*channel->scale, idx, instances, count);
+        ++ idx;
+    }
+}
+
+void clip_sampler::sample_translate(animation_clip::translate_channel_t const& kf, uint32_t channel,
+                                    instance_t* const* instances, size_t count) {
+    size_t num = 0;
+    _targets.clear();
+
+    // gather
+    for (size_t i = 0; i < count; ++i) {
+        auto* inst = instances[i];
+        auto joint = inst->base().binding->joints[channel];
+        if (joint < 0)
+            continue;
+
+        auto seg = kf.segment(_offsets[i], inst->base().cursors[joint].translate);
+        auto const& from = kf.key(seg.from);
+        auto const& to = kf.key(seg.to);
+        auto const& setup = inst->_animation->setup_poses()[joint].translate;
+        _from3.row(num) << from.x(), from.y(), from.z();
+        _to3.row(num) << to.x(), to.y(), to.z();
+        _setup3.row(num) << setup.x(), setup.y(), setup.z();
+        _progress(num) = seg.progress;
+        _targets.emplace_back(inst->_animation->transforms()[joint]);
+        ++ num;
+    }
+
+    if (num == 0)
+        return;
+
+    // setup + lerp(from, to, p)
+    auto progress = _progress.head(num);
+    array3f_t result = _setup3.topRows(num) + _from3.topRows(num)
+        + (_to3.topRows(num) - _from3.topRows(num)).colwise() * progress;
+
+    // scatter
+    for (size_t i = 0; i < num; ++i) {
+        _targets[i]->set_translate(vector3f(result(i, 0), result(i, 1), result(i, 2)));
+        _targets[i]->mark_dirty();
+    }
+}
+
+void clip_sampler::sample_scale(animation_clip::scale_channel_t const& kf, uint32_t channel,
+                                instance_t* const* instances, size_t count) {
+    size_t num = 0;
+    _targets.clear();
+
+    // gather
+    for (size_t i = 0; i < count; ++i) {
+        auto* inst = instances[i];
+        auto joint = inst->base().binding->joints[channel];
+        if (joint < 0)
+            continue;
+
+        auto seg = kf.segment(_offsets[i], inst->base().cursors[joint].scale);
+        auto const& from = kf.key(seg.from);
+        auto const& to = kf.key(seg.to);
+        auto const& setup = inst->_animation->setup_poses()[joint].scale;
+        _from3.row(num) << from.x(), from.y(), from.z();
+        _to3.row(num) << to.x(), to.y(), to.z();
+        _setup3.row(num) << setup.x(), setup.y(), setup.z();
+        _progress(num) = seg.progress;
+        _targets.emplace_back(inst->_animation->transforms()[joint]);
+        ++ num;
+    }
+
+    if (num == 0)
+        return;
+
+    // setup * lerp(from, to, p)
+    auto progress = _progress.head(num);
+    array3f_t result = _setup3.topRows(num) * (_from3.topRows(num)
+        + (_to3.topRows(num) - _from3.topRows(num)).colwise() * progress);
+
+    // scatter
+    for (size_t i = 0; i < num; ++i) {
+        _targets[i]->set_scale(vector3f(result(i, 0), result(i, 1), result(i, 2)));
+        _targets[i]->mark_dirty();
+    }
+}
+
+void clip_sampler::sample_rotate(animation_clip::rotate_channel_t const& kf, uint32_t channel,
+                                 instance_t* const* instances, size_t count) {
+    size_t num = 0;
+    _targets.clear();
+
+    // gather
+    for (size_t i = 0; i < count; ++i) {
+        auto* inst = instances[i];
+        auto joint = inst->base().binding->joints[channel];
+        if (joint < 0)
+            continue;
+
+        auto seg = kf.segment(_offsets[i], inst->base().cursors[joint].rotate);
+        auto const& from = kf.key(seg.from);
+        auto const& to = kf.key(seg.to);
+        auto const& setup = inst->_animation->setup_poses()[joint].rotate;
+        _from4.row(num) << from.x(), from.y(), from.z(), from.w();
+        _to4.row(num) << to.x(), to.y(), to.z(), to.w();
+        _setup4.row(num) << setup.x(), setup.y(), setup.z(), setup.w();
+        _progress(num) = seg.progress;
+        _targets.emplace_back(inst->_animation->transforms()[joint]);
+        ++ num;
+    }
+
+    if (num == 0)
+        return;
+
+    // slerp(from, to, p), the same as quaternion::slerp
+    auto t = _progress.head(num);
+    auto a = _from4.topRows(num);
+    auto b = _to4.topRows(num);
+    static const float one = 1.f - Eigen::NumTraits<float>::epsilon();
+
+    array1f_t d = a.col(0) * b.col(0) + a.col(1) * b.col(1)
+        + a.col(2) * b.col(2) + a.col(3) * b.col(3);
+    array1f_t abs_d = d.abs();
+    array1f_t theta = abs_d.min(one).acos();
+    array1f_t sin_theta = theta.sin();
+    array1f_t scale0 = (abs_d >= one).select(1.f - t, ((1.f - t) * theta).sin() / sin_theta);
+    array1f_t scale1 = (abs_d >= one).select(t, (t * theta).sin() / sin_theta);
+    scale1 = (d < 0.f).select(-scale1, scale1);
+
+    array4f_t q = a.colwise() * scale0 + b.colwise() * scale1;
+
+    // setup * q
+    auto s = _setup4.topRows(num);
+    array4f_t r(num, 4);
+    r.col(0) = s.col(3) * q.col(0) + s.col(0) * q.col(3) + s.col(1) * q.col(2) - s.col(2) * q.col(1);
+    r.col(1) = s.col(3) * q.col(1) - s.col(0) * q.col(2) + s.col(1) * q.col(3) + s.col(2) * q.col(0);
+    r.col(2) = s.col(3) * q.col(2) + s.col(0) * q.col(1) - s.col(1) * q.col(0) + s.col(2) * q.col(3);
+    r.col(3) = s.col(3) * q.col(3) - s.col(0) * q.col(0) - s.col(1) * q.col(1) - s.col(2) * q.col(2);
+
+    // scatter
+    for (size_t i = 0; i < num; ++i) {
+        _targets[i]->set_rotate(quaternionf(r(i, 3), r(i, 0), r(i, 1), r(i, 2)));
+        _targets[i]->mark_dirty();
+    }
+}
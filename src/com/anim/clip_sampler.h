@@ -0,0 +1,55 @@
+#ifndef _CHAOS3D_COM_ANIM_CLIP_SAMPLER_H
+#define _CHAOS3D_COM_ANIM_CLIP_SAMPLER_H
+
+#include "com/anim/animation_clip.h"
+#include "common/base_types.h"
+#include <vector>
+
+namespace act {
+    class action_animation;
+}
+
+namespace com {
+    class transform;
+
+    /// sample one animation clip for many playing instances at once
+    ///
+    /// for each channel, the keys of all the instances are gathered into
+    /// structure-of-arrays, interpolated (linear/slerp) by Eigen arrays so
+    /// they are vectorized, and written straight to the joint transforms.
+    /// the results are the same as updating each action_animation.
+    class clip_sampler {
+    public:
+        typedef act::action_animation instance_t;
+        typedef timer::time_t time_t;
+
+        // fewer instances of the same clip are not worth batching
+        enum { MinBatch = 4 };
+
+    public:
+        /// sample the clip for the instances, all playing the given clip
+        void sample(animation_clip const&, instance_t* const* instances, size_t count);
+
+    private:
+        typedef Eigen::Array<float, Eigen::Dynamic, 1> array1f_t;
+        typedef Eigen::Array<float, Eigen::Dynamic, 3> array3f_t; // x, y, z
+        typedef Eigen::Array<float, Eigen::Dynamic, 4> array4f_t; // x, y, z, w
+        typedef std::vector<transform*> targets_t;
+
+        void sample_translate(animation_clip::translate_channel_t const&, uint32_t channel,
+                              instance_t* const* instances, size_t count);
+        void sample_scale(animation_clip::scale_channel_t const&, uint32_t channel,
+                          instance_t* const* instances, size_t count);
+        void sample_rotate(animation_clip::rotate_channel_t const&, uint32_t channel,
+                           instance_t* const* instances, size_t count);
+
+        // scratch buffers, kept to avoid allocating every frame
+        std::vector<time_t> _offsets;
+        targets_t _targets;
+        array1f_t _progress;
+        array3f_t _from3, _to3, _setup3;
+        array4f_t _from4, _to4, _setup4;
+    };
+}
+
+#endif
@@ -0,0 +1,245 @@
+#include "com/anim/skeleton.h"
+#include "com/anim/skeleton_binary.h"
+#include "com/sprite2d/texture_atlas.h"
+#include "loader/json/json_loader.h"
+#include "io/memory_stream.h"
+#include "common/log.h"
+#include <rapidjson/document.h>
+
+using namespace com;
+using namespace rapidjson; // TODO: move this out of this scope
+typedef rapidjson::GenericValue<rapidjson::UTF8<char>> json_value_t;
+
+#define QUATERNION_Z(r) quaternionf(Eigen::AngleAxisf(r*M_PI/180.f, vector3f::UnitZ()))
+
+skeleton::ptr skeleton::load_from(data_stream* ds, std::vector<texture_atlas*> const& atlases,
+                                  compression const* compressed) {
+    if (ds == nullptr || !ds->valid()) {
+        LOG_WARN(skeleton, "the stream is not ready, ignore loading");
+        return nullptr;
+    }
+    
+    ptr skel(new skeleton());
+    bool loaded = false;
+    if (skeleton_binary::is_binary(ds)) {
+        // read in place if it's in the memory already
+        auto* mem = dynamic_cast<memory_stream*>(ds);
+        if (mem != nullptr) {
+            loaded = skeleton_binary::read(*skel, mem->address(), mem->size());
+        } else {
+            std::vector<char> blob(ds->size());
+            blob.resize(ds->read(blob.data(), blob.size()));
+            loaded = skeleton_binary::read(*skel, blob.data(), blob.size());
+        }
+    } else {
+        loaded = skel->load_json(ds);
+    }
+    
+    if (!loaded)
+        return nullptr;
+    
+    for (auto& atlas : atlases) {
+        skel->add_atlas(atlas);
+    }
+    
+    if (compressed != nullptr)
+        skel->compress(*compressed);
+    return skel;
+}
+
+bool skeleton::save_binary(std::vector<char>& blob) const {
+    return skeleton_binary::write(*this, blob);
+}
+
+bool skeleton::save_binary(std::string const& filename) const {
+    std::vector<char> blob;
+    if (!save_binary(blob))
+        return false;
+
+    // the other readers see either the whole or none
+    std::string temp = filename + ".tmp";
+    FILE* fp = fopen(temp.c_str(), "wb");
+    if (fp == nullptr) {
+        LOG_WARN("unable to write the skeleton: " << filename);
+        return false;
+    }
+
+    bool ok = fwrite(blob.data(), 1, blob.size(), fp) == blob.size();
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(temp.c_str(), filename.c_str()) != 0) {
+        LOG_WARN("unable to write the skeleton: " << filename);
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+template<typename C>
+void skeleton::load_skin(const std::string &name, C const& value) {
+    LOG_INFO("skin : " << typeid(C).name());
+    auto skin_ret = _skins.emplace(name, skin_t());
+    if (!skin_ret.second) {
+        LOG_WARN("the skin is dup, skipped: " << name);
+        return;
+    }
+    
+    auto& skin = skin_ret.first->second;
+    for (auto itr = value.MemberBegin(); itr != value.MemberEnd(); ++itr) {
+        // slot name is ignored. TODO: preprocessor to reorg the data
+        
+        for (auto sprite_it = itr->value.MemberBegin();
+             sprite_it != itr->value.MemberEnd(); ++sprite_it) {
+            auto* name = sprite_it->name.GetString();
+            double rotation = 0.f;
+            box2f bound;
+            vector3f translate;
+            
+            for (auto attr = sprite_it->value.MemberBegin();
+                 attr != sprite_it->value.MemberEnd(); ++attr) {
+                if (strcmp(attr->name.GetString(), "name") == 0) {
+                    name = attr->value.GetString();
+                } else if (strcmp(attr->name.GetString(), "x") == 0) {
+                    translate.x() = attr->value.GetDouble();
+                } else if (strcmp(attr->name.GetString(), "y") == 0) {
+                    translate.y() = attr->value.GetDouble();
+                } else if (strcmp(attr->name.GetString(), "width") == 0) {
+                    bound.min().x() = -attr->value.GetDouble() / 2.0;
+                    bound.max().x() = attr->value.GetDouble() / 2.0;
+                } else if (strcmp(attr->name.GetString(), "height") == 0) {
+                    bound.min().y() = -attr->value.GetDouble() / 2.0;
+                    bound.max().y() = attr->value.GetDouble() / 2.0;
+                } else if (strcmp(attr->name.GetString(), "rotation") == 0) {
+                    rotation = attr->value.GetDouble();
+                }
+            }
+            
+            skin.emplace(std::piecewise_construct,
+                         std::forward_as_tuple(name),
+                         std::forward_as_tuple(skin_piece{nullptr, bound, translate, rotation}));
+        }
+        
+    }
+}
+
+bool skeleton::load_json(data_stream* ds) {
+    json_document doc(ds);
+    auto& json = doc.internal<rapidjson::Document>();
+    auto& joints = json["bones"];
+    if (joints.IsArray()) {
+        for (auto it = joints.Begin(); it != joints.End(); ++it) {
+            auto* name = (*it)["name"].GetString();
+            int32_t parent_idx = -1;
+            double x = 0.f, y = 0.f, scaleX = 1.f, scaleY = 1.f;
+            double rotate = 0.f;
+
+            for (auto itr = it->MemberBegin(); itr != it->MemberEnd(); ++itr) {
+                if (strcmp(itr->name.GetString(), "x") == 0) {
+                    x = itr->value.GetDouble();
+                } else if (strcmp(itr->name.GetString(), "y") == 0) {
+                    y = itr->value.GetDouble();
+                } else if (strcmp(itr->name.GetString(), "scaleX") == 0) {
+                    scaleX = itr->value.GetDouble();
+                } else if (strcmp(itr->name.GetString(), "scaleY") == 0) {
+                    scaleY = itr->value.GetDouble();
+                } else if (strcmp(itr->name.GetString(), "rotation") == 0) {
+                    rotate = itr->value.GetDouble();
+                } else if (strcmp(itr->name.GetString(), "parent") == 0) {
+                    auto pid = _names.find(std::string(itr->value.GetString()));
+                    if (pid != _names.end()) {
+                        parent_idx = pid->second;
+                    } else {
+                        LOG_WARN("parent joint is not defined yet: " << itr->value.GetString());
+                    }
+                }
+            }
+            add_joint(name, parent_idx, joint_pose{
+                vector3f(x, y, 0.f),
+                vector3f(scaleX, scaleY, 1.f),
+                QUATERNION_Z(rotate)
+            });
+        }
+    }
+    
+    auto& skins = json["skins"];
+    if (skins.IsObject()) {
+        for (auto it = skins.MemberBegin(); it != skins.MemberEnd(); ++it) {
+            load_skin(it->name.GetString(), it->value);
+        }
+        // if loaded any skin, set the first one to be default and load afterwards
+        if (!_skins.empty()) {
+            _default_skin = skins.MemberBegin()->name.GetString();
+        }
+    }
+    
+    auto& slots = json["slots"];
+    if (slots.IsArray()) {
+        int32_t index = 0;
+        for (auto it = slots.Begin(); it != slots.End(); ++it) {
+            auto* name = (*it)["name"].GetString();
+            std::string joint = (*it)["bone"].GetString();
+            auto jit = _names.find(joint);
+            if (jit == _names.end()) {
+                LOG_WARN("the joint is not defined, ignored: " << joint);
+                continue;
+            }
+            auto& attachement = (*it)["attachment"];
+            char const* piece_name = "";
+            
+            if (attachement.IsString()) {
+                piece_name = attachement.GetString();
+            }
+
+            _slots.emplace(std::piecewise_construct,
+                           std::forward_as_tuple(name),
+                           std::forward_as_tuple(jit->second, ++index, piece_name));
+        }
+    }
+
+    auto& animations = json["animations"];
+    if (animations.IsObject()) {
+        for (auto anim = animations.MemberBegin();
+             anim != animations.MemberEnd(); ++anim) {
+            
+            add_clip(anim->name.GetString(), animation_clip::load_from(anim->value));
+        }
+    }
+    
+    return true;
+}
+
+void skeleton::add_joint(char const* name, int32_t parent, joint_pose const& pose) {
+    _names.emplace(std::piecewise_construct,
+                   std::forward_as_tuple(name),
+                   std::forward_as_tuple(_setup_poses.size()));
+    _parents.emplace_back(parent);
+    _setup_poses.emplace_back(pose);
+}
+
+void skeleton::add_clip(std::string const& name, animation_clip::ptr const& clip) {
+    auto& binding = _clips[name];
+    binding.clip = clip;
+    binding.channels.assign(_setup_poses.size(), nullptr);
+    clip->get_channels(_names, binding.channels);
+    clip->get_joints(_names, binding.joints);
+}
+
+void skeleton::compress(compression const& tolerance) {
+    for (auto& it : _clips) {
+        it.second.clip->compress(tolerance.translate, tolerance.scale, tolerance.rotate);
+    }
+}
+
+skeleton::clip_binding const* skeleton::find_clip(std::string const& name) const {
+    auto it = _clips.find(name);
+    return it == _clips.end() ? nullptr : &it->second;
+}
+
+void skeleton::add_atlas(texture_atlas* atlas) {
+    for (auto& skin : _skins) {
+        for (auto& piece : skin.second) {
+            if (atlas->has_frame(piece.first)) {
+                piece.second.atlas = atlas;
+            }
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#ifndef _CHAOS3D_COM_ANIM_SKELETON_H
+#define _CHAOS3D_COM_ANIM_SKELETON_H
+
+#include "common/referenced_count.h"
+#include "common/base_types.h"
+#include "com/anim/animation_clip.h"
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <map>
+
+class data_stream;
+class texture_atlas;
+
+namespace com {
+    class skeleton_binary;
+
+    /// the immutable skeleton definition: the joints and their setup poses,
+    /// slots, skins and animation clips
+    ///
+    /// it is shared by all the animation instances of the same data, each of
+    /// which only keeps its own joint transforms and the playing states.
+    class skeleton : public referenced_count {
+    public:
+        typedef std::unique_ptr<skeleton, release_deleter> ptr;
+        typedef std::unique_ptr<skeleton const, release_deleter> const_ptr;
+
+        typedef std::unordered_map<std::string, uint32_t> names_t;
+        typedef std::vector<int32_t> parents_t;
+
+        // FIXME: better skin struct
+        struct skin_piece {
+            texture_atlas*  atlas;
+            box2f           bound;      // sprite bound
+            vector3f        translate;  // translate
+            double          rotation;
+        };
+        typedef std::unordered_map<std::string, skin_piece> skin_t;
+        typedef std::map<std::string, skin_t> skins_t;
+
+        struct joint_pose {
+            vector3f translate;
+            vector3f scale;
+            quaternionf rotate;
+        };
+        typedef std::vector<joint_pose> joint_poses_t;
+
+        struct slot {
+            uint32_t    joint_index;    // joint index in joint pose array
+            int32_t     sprite_index;   // sprite drawing order, from 1
+            std::string piece_name;     // skin piece name
+
+            slot(uint32_t idx, int32_t sid, char const* name)
+            : joint_index(idx), sprite_index(sid), piece_name(name)
+            {}
+        };
+        typedef std::unordered_map<std::string, slot> slots_t;
+
+        /// the clip and its channels bound to the joints, resolved once
+        struct clip_binding {
+            animation_clip::ptr clip;
+            animation_clip::channels_t channels;    // joint => clip channel
+            animation_clip::joints_t joints;        // clip channel => joint index
+        };
+        typedef std::unordered_map<std::string, clip_binding> clips_t;
+
+        /// the tolerances to compress the clips (see animation_clip::compress)
+        struct compression {
+            float translate = .25f;
+            float scale = .001f;
+            float rotate = .001f;
+        };
+
+    public:
+        /// load the data from the stream, either the json or the
+        /// precompiled binary (see skeleton_binary); the skins are bound
+        /// to the atlases and the clips compressed if given, once here
+        /// before it's shared
+        static ptr load_from(data_stream*, std::vector<texture_atlas*> const& = {},
+                             compression const* = nullptr);
+
+        /// compile to the binary blob, which loads much faster than the json
+        bool save_binary(std::vector<char>&) const;
+
+        /// compile and save to the file, i.e. on the host to ship the blob
+        /// instead of the json (see load_skeleton/save_binary in lua)
+        bool save_binary(std::string const& filename) const;
+
+        /// the joint name to index mapping
+        names_t const& names() const { return _names; }
+
+        /// the parent index of the joints, -1 for the root ones; the parents
+        /// always come before their children
+        parents_t const& parents() const { return _parents; }
+
+        /// the initial setup poses of the joints
+        joint_poses_t const& setup_poses() const { return _setup_poses; }
+
+        slots_t const& slots() const { return _slots; }
+        skins_t const& skins() const { return _skins; }
+        std::string const& default_skin() const { return _default_skin; }
+
+        /// the named clip, or nullptr
+        clip_binding const* find_clip(std::string const&) const;
+
+    protected:
+        skeleton() = default;
+        virtual ~skeleton() = default;
+
+    private:
+        bool load_json(data_stream*);
+
+        /// load skin, template to remove dependencies
+        template<typename C>
+        void load_skin(std::string const&, C const&);
+
+        void add_joint(char const* name, int32_t parent, joint_pose const&);
+        void add_clip(std::string const&, animation_clip::ptr const&);
+
+        /// fill the skins from the atlas
+        void add_atlas(texture_atlas*);
+
+        /// compress all the clips in place
+        void compress(compression const&);
+
+        names_t _names;             // joint names => joint index lookup
+        parents_t _parents;         // joint => parent joint
+        joint_poses_t _setup_poses; // setup poses
+        slots_t _slots;             // skin names => slot config
+        skins_t _skins;             // skins sets
+        clips_t _clips;             // animation clips
+        std::string _default_skin;  // applied to the instances
+
+        friend class skeleton_binary;
+    };
+}
+
+#endif
@@ -0,0 +1,457 @@
+#include "com/anim/skeleton_binary.h"
+#include "com/anim/skeleton.h"
+#include "com/anim/animation_clip.h"
+#include "io/data_stream.h"
+#include "common/log.h"
+#include <unordered_map>
+#include <cstring>
+
+using namespace com;
+
+namespace {
+    typedef skeleton_binary::tables tables_t;
+    typedef skeleton_binary::track_rec track_rec_t;
+    
+    // the packed keys of any track are the same size
+    static_assert(keyframe_codec<vector3f>::words == keyframe_codec<quaternionf>::words,
+                  "the packed keys differ in size");
+    enum { PackedWords = keyframe_codec<vector3f>::words };
+
+    // names are pooled, the same string is saved once
+    struct string_table {
+        std::vector<char> data;
+        std::unordered_map<std::string, uint32_t> offsets;
+
+        uint32_t operator() (std::string const& str) {
+            auto it = offsets.find(str);
+            if (it != offsets.end())
+                return it->second;
+
+            uint32_t offset = static_cast<uint32_t>(data.size());
+            data.insert(data.end(), str.c_str(), str.c_str() + str.size() + 1);
+            offsets.emplace(str, offset);
+            return offset;
+        }
+    };
+
+    // the vector codec keeps the range of the keys, the quaternion one
+    // has nothing to keep
+    void save_codec(keyframe_codec<vector3f> const& codec, track_rec_t& rec) {
+        for (int c = 0; c < 3; ++c) {
+            rec.min[c] = codec.min[c];
+            rec.step[c] = codec.step[c];
+        }
+    }
+
+    void save_codec(keyframe_codec<quaternionf> const&, track_rec_t&) {}
+
+    void load_codec(track_rec_t const& rec, keyframe_codec<vector3f>& codec) {
+        codec.min = vector3f(rec.min[0], rec.min[1], rec.min[2]);
+        codec.step = vector3f(rec.step[0], rec.step[1], rec.step[2]);
+    }
+
+    void load_codec(track_rec_t const&, keyframe_codec<quaternionf>&) {}
+
+    struct track_writer {
+        std::vector<track_rec_t> tracks;
+        std::vector<float> offsets;
+        std::vector<float> values;
+        std::vector<uint16_t> words;
+        std::vector<uint8_t> types;
+        bool unsupported = false;   // a key that can't be saved in 2d
+
+        template<class Channel, class F>
+        uint32_t operator() (Channel const* channel, F const& value) {
+            if (channel == nullptr)
+                return skeleton_binary::None;
+
+            auto const& infos = channel->frame_infos();
+            track_rec_t rec = {
+                static_cast<uint32_t>(offsets.size()),
+                static_cast<uint32_t>(channel->size()),
+                static_cast<uint32_t>(channel->wrap()),
+                skeleton_binary::Raw,
+                static_cast<uint32_t>(values.size()),
+                {0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}
+            };
+            for (auto& info : infos) {
+                offsets.push_back(info.offset);
+                types.push_back(info.type);
+            }
+
+            // the compressed keys are saved packed as they are
+            if (channel->compressed()) {
+                rec.codec = skeleton_binary::Packed;
+                rec.data = static_cast<uint32_t>(words.size());
+                save_codec(channel->codec(), rec);
+                words.insert(words.end(), channel->packed().begin(), channel->packed().end());
+            } else {
+                for (size_t i = 0; i < channel->size(); ++i)
+                    unsupported = !value(channel->key(i), values) || unsupported;
+            }
+            tracks.push_back(rec);
+            return static_cast<uint32_t>(tracks.size() - 1);
+        }
+    };
+
+    // only z rotations and x/y translations/scales are saved, the
+    // others are rejected not to be dropped silently
+    bool is_2d(quaternionf const& rotate) {
+        return std::abs(rotate.x()) <= FLT_EPSILON && std::abs(rotate.y()) <= FLT_EPSILON;
+    }
+
+    bool is_2d(vector3f const& key, float z) {
+        return std::abs(key.z() - z) <= FLT_EPSILON;
+    }
+
+    template<class T>
+    void append(std::vector<char>& blob, std::vector<T> const& records) {
+        auto* first = reinterpret_cast<char const*>(records.data());
+        blob.insert(blob.end(), first, first + records.size() * sizeof(T));
+    }
+
+    template<class Channel, class F>
+    typename Channel::ptr load_track(tables_t const& blob, uint32_t idx, F const& key) {
+        if (idx == skeleton_binary::None)
+            return nullptr;
+
+        auto const& track = blob.tracks[idx];
+        typename Channel::frame_infos_t infos;
+        infos.reserve(track.count);
+        for (uint32_t k = track.first; k < track.first + track.count; ++k)
+            infos.push_back(keyframe_info{blob.offsets[k], blob.types[k]});
+
+        if (track.codec == skeleton_binary::Packed) {
+            typename Channel::codec_t codec;
+            load_codec(track, codec);
+            auto* words = blob.words + track.data;
+            std::vector<uint16_t> packed(words, words + track.count * PackedWords);
+            return Channel::create(static_cast<int>(track.wrap), infos, packed, codec);
+        }
+
+        typename Channel::key_frames_t keys;
+        keys.reserve(track.count);
+        for (uint32_t k = 0; k < track.count; ++k)
+            keys.emplace_back(key(blob.values + track.data + k * 2));
+        return Channel::create(static_cast<int>(track.wrap), infos, keys);
+    }
+}
+
+template<>
+animation_clip::animation_clip(skeleton_binary::clip_view const& view) {
+    auto const& blob = view.blob;
+    for (uint32_t i = 0; i < view.clip.count; ++i) {
+        auto const& rec = blob.channels[view.clip.first + i];
+        _names.emplace(blob.string(rec.name), _channels.size());
+        _channels.emplace_back(new clip_channel());
+        auto* channel = _channels.back().get();
+
+        channel->translate = load_track<translate_channel_t>(blob, rec.translate, [] (float const* v) {
+            return vector3f(v[0], v[1], 0.f);
+        });
+        channel->scale = load_track<scale_channel_t>(blob, rec.scale, [] (float const* v) {
+            return vector3f(v[0], v[1], 1.f);
+        });
+        channel->rotate = load_track<rotate_channel_t>(blob, rec.rotate, [] (float const* v) {
+            return quaternionf(v[1], 0.f, 0.f, v[0]);
+        });
+    }
+}
+
+bool skeleton_binary::is_binary(data_stream* ds) {
+    uint32_t magic = 0;
+    long pos = ds->tell();
+    size_t read = ds->read(&magic, sizeof(magic));
+    ds->seek(pos, data_stream::SeekSet);
+    return read == sizeof(magic) && magic == Magic;
+}
+
+uint64_t skeleton_binary::blob_size(header const& head) {
+    return sizeof(header)
+        + uint64_t(head.joints) * sizeof(joint_rec)
+        + uint64_t(head.slots) * sizeof(slot_rec)
+        + uint64_t(head.skins) * sizeof(skin_rec)
+        + uint64_t(head.pieces) * sizeof(piece_rec)
+        + uint64_t(head.clips) * sizeof(clip_rec)
+        + uint64_t(head.channels) * sizeof(channel_rec)
+        + uint64_t(head.tracks) * sizeof(track_rec)
+        + uint64_t(head.keys) * (sizeof(float) + sizeof(uint8_t))
+        + uint64_t(head.values) * sizeof(float)
+        + uint64_t(head.words) * sizeof(uint16_t)
+        + head.strings;
+}
+
+bool skeleton_binary::map(char const* data, size_t size, tables& blob) {
+    if (size < sizeof(header))
+        return false;
+
+    auto const* head = reinterpret_cast<header const*>(data);
+    if (head->magic != Magic || head->version != Version
+        || blob_size(*head) > size || head->strings == 0)
+        return false;
+
+    char const* cur = data + sizeof(header);
+    auto next = [&cur] (size_t bytes) {
+        auto* ret = cur;
+        cur += bytes;
+        return ret;
+    };
+    blob.head = head;
+    blob.joints = reinterpret_cast<joint_rec const*>(next(head->joints * sizeof(joint_rec)));
+    blob.slots = reinterpret_cast<slot_rec const*>(next(head->slots * sizeof(slot_rec)));
+    blob.skins = reinterpret_cast<skin_rec const*>(next(head->skins * sizeof(skin_rec)));
+    blob.pieces = reinterpret_cast<piece_rec const*>(next(head->pieces * sizeof(piece_rec)));
+    blob.clips = reinterpret_cast<clip_rec const*>(next(head->clips * sizeof(clip_rec)));
+    blob.channels = reinterpret_cast<channel_rec const*>(next(head->channels * sizeof(channel_rec)));
+    blob.tracks = reinterpret_cast<track_rec const*>(next(head->tracks * sizeof(track_rec)));
+    blob.offsets = reinterpret_cast<float const*>(next(head->keys * sizeof(float)));
+    blob.values = reinterpret_cast<float const*>(next(head->values * sizeof(float)));
+    blob.words = reinterpret_cast<uint16_t const*>(next(head->words * sizeof(uint16_t)));
+    blob.types = reinterpret_cast<uint8_t const*>(next(head->keys * sizeof(uint8_t)));
+    blob.strings = next(head->strings);
+
+    // only the ranges are checked, the records are used as they are
+    if (blob.strings[head->strings - 1] != '\0')
+        return false;
+
+    auto string_ok = [head] (uint32_t str) { return str < head->strings; };
+    auto track_ok = [head] (uint32_t track) { return track == None || track < head->tracks; };
+    // [first, first + count) within the size, not to wrap around
+    auto range_ok = [] (uint64_t first, uint64_t count, uint64_t size) {
+        return count <= size && first <= size - count;
+    };
+    for (uint32_t i = 0; i < head->joints; ++i) {
+        auto const& rec = blob.joints[i];
+        // the parents come first, -1 for the roots
+        if (!string_ok(rec.name) || rec.parent < -1 || rec.parent >= static_cast<int32_t>(i))
+            return false;
+    }
+    for (uint32_t i = 0; i < head->slots; ++i) {
+        auto const& rec = blob.slots[i];
+        if (!string_ok(rec.name) || !string_ok(rec.piece) || rec.joint >= head->joints)
+            return false;
+    }
+    for (uint32_t i = 0; i < head->skins; ++i) {
+        auto const& rec = blob.skins[i];
+        if (!string_ok(rec.name) || !range_ok(rec.first, rec.count, head->pieces))
+            return false;
+    }
+    for (uint32_t i = 0; i < head->pieces; ++i) {
+        if (!string_ok(blob.pieces[i].name))
+            return false;
+    }
+    for (uint32_t i = 0; i < head->clips; ++i) {
+        auto const& rec = blob.clips[i];
+        if (!string_ok(rec.name) || !range_ok(rec.first, rec.count, head->channels))
+            return false;
+    }
+    for (uint32_t i = 0; i < head->channels; ++i) {
+        auto const& rec = blob.channels[i];
+        if (!string_ok(rec.name) || !track_ok(rec.translate)
+            || !track_ok(rec.scale) || !track_ok(rec.rotate))
+            return false;
+    }
+    for (uint32_t i = 0; i < head->tracks; ++i) {
+        auto const& rec = blob.tracks[i];
+        if (rec.count == 0 || !range_ok(rec.first, rec.count, head->keys))
+            return false;
+        bool data_ok = rec.codec == Packed
+            ? range_ok(rec.data, uint64_t(rec.count) * PackedWords, head->words)
+            : rec.codec == Raw && range_ok(rec.data, uint64_t(rec.count) * 2, head->values);
+        if (!data_ok)
+            return false;
+    }
+    return head->default_skin == None || string_ok(head->default_skin);
+}
+
+bool skeleton_binary::write(skeleton const& skel, std::vector<char>& blob) {
+    string_table strings;
+    track_writer keys;
+    std::vector<joint_rec> joints;
+    std::vector<slot_rec> slots;
+    std::vector<skin_rec> skins;
+    std::vector<piece_rec> pieces;
+    std::vector<clip_rec> clips;
+    std::vector<channel_rec> channels;
+
+    // joints, in the index order
+    std::vector<std::string> names(skel._setup_poses.size());
+    for (auto& it : skel._names)
+        names[it.second] = it.first;
+
+    for (size_t i = 0; i < skel._setup_poses.size(); ++i) {
+        auto const& pose = skel._setup_poses[i];
+        if (!is_2d(pose.rotate)) {
+            LOG_WARN(skeleton_binary, "the rotation is not about z, it is not supported: " << names[i]);
+            return false;
+        }
+        if (!is_2d(pose.translate, 0.f) || !is_2d(pose.scale, 1.f)) {
+            LOG_WARN(skeleton_binary, "the pose is not in 2d, it is not supported: " << names[i]);
+            return false;
+        }
+
+        joints.push_back(joint_rec{
+            strings(names[i]),
+            skel._parents[i],
+            {pose.translate.x(), pose.translate.y()},
+            {pose.scale.x(), pose.scale.y()},
+            {pose.rotate.z(), pose.rotate.w()}
+        });
+    }
+
+    for (auto& it : skel._slots) {
+        slots.push_back(slot_rec{
+            strings(it.first),
+            it.second.joint_index,
+            strings(it.second.piece_name),
+            it.second.sprite_index
+        });
+    }
+
+    for (auto& skin : skel._skins) {
+        skins.push_back(skin_rec{
+            strings(skin.first),
+            static_cast<uint32_t>(pieces.size()),
+            static_cast<uint32_t>(skin.second.size())
+        });
+        for (auto& it : skin.second) {
+            auto const& piece = it.second;
+            pieces.push_back(piece_rec{
+                strings(it.first),
+                {piece.bound.min().x(), piece.bound.min().y()},
+                {piece.bound.max().x(), piece.bound.max().y()},
+                {piece.translate.x(), piece.translate.y()},
+                static_cast<float>(piece.rotation)
+            });
+        }
+    }
+
+    for (auto& clip : skel._clips) {
+        auto const& clip_channels = clip.second.clip->channels();
+        std::vector<std::string> channel_names(clip_channels.size());
+        for (auto& it : clip.second.clip->names())
+            channel_names[it.second] = it.first;
+
+        clips.push_back(clip_rec{
+            strings(clip.first),
+            static_cast<uint32_t>(channels.size()),
+            static_cast<uint32_t>(clip_channels.size())
+        });
+        for (size_t i = 0; i < clip_channels.size(); ++i) {
+            auto const* channel = clip_channels[i].get();
+            channels.push_back(channel_rec{
+                strings(channel_names[i]),
+                keys(channel->translate.get(), [] (vector3f const& key, std::vector<float>& values) {
+                    values.push_back(key.x());
+                    values.push_back(key.y());
+                    return is_2d(key, 0.f);
+                }),
+                keys(channel->scale.get(), [] (vector3f const& key, std::vector<float>& values) {
+                    values.push_back(key.x());
+                    values.push_back(key.y());
+                    return is_2d(key, 1.f);
+                }),
+                keys(channel->rotate.get(), [] (quaternionf const& key, std::vector<float>& values) {
+                    values.push_back(key.z());
+                    values.push_back(key.w());
+                    return is_2d(key);
+                })
+            });
+
+            if (keys.unsupported) {
+                LOG_WARN(skeleton_binary, "the keys are not in 2d, it is not supported: "
+                         << clip.first << '/' << channel_names[i]);
+                return false;
+            }
+        }
+    }
+
+    header head = {
+        Magic, Version,
+        static_cast<uint32_t>(joints.size()),
+        static_cast<uint32_t>(slots.size()),
+        static_cast<uint32_t>(skins.size()),
+        static_cast<uint32_t>(pieces.size()),
+        static_cast<uint32_t>(clips.size()),
+        static_cast<uint32_t>(channels.size()),
+        static_cast<uint32_t>(keys.tracks.size()),
+        static_cast<uint32_t>(keys.offsets.size()),
+        static_cast<uint32_t>(keys.values.size()),
+        static_cast<uint32_t>(keys.words.size()),
+        0,
+        skel._default_skin.empty() ? None : strings(skel._default_skin)
+    };
+    strings("");    // the table is never empty
+    head.strings = static_cast<uint32_t>(strings.data.size());
+
+    blob.clear();
+    blob.reserve(blob_size(head));
+    auto* first = reinterpret_cast<char const*>(&head);
+    blob.insert(blob.end(), first, first + sizeof(head));
+    append(blob, joints);
+    append(blob, slots);
+    append(blob, skins);
+    append(blob, pieces);
+    append(blob, clips);
+    append(blob, channels);
+    append(blob, keys.tracks);
+    append(blob, keys.offsets);
+    append(blob, keys.values);
+    append(blob, keys.words);
+    append(blob, keys.types);
+    append(blob, strings.data);
+    assert(blob.size() == blob_size(head));
+    return true;
+}
+
+bool skeleton_binary::read(skeleton& skel, char const* data, size_t size) {
+    tables blob;
+    if (!map(data, size, blob)) {
+        LOG_WARN(skeleton_binary, "the skeleton blob is not valid, ignore loading");
+        return false;
+    }
+
+    auto const& head = *blob.head;
+    for (uint32_t i = 0; i < head.joints; ++i) {
+        auto const& rec = blob.joints[i];
+        skel.add_joint(blob.string(rec.name), rec.parent, skeleton::joint_pose{
+            vector3f(rec.translate[0], rec.translate[1], 0.f),
+            vector3f(rec.scale[0], rec.scale[1], 1.f),
+            quaternionf(rec.rotate[1], 0.f, 0.f, rec.rotate[0])
+        });
+    }
+
+    for (uint32_t i = 0; i < head.skins; ++i) {
+        auto const& rec = blob.skins[i];
+        auto& skin = skel._skins[blob.string(rec.name)];
+        for (uint32_t p = rec.first; p < rec.first + rec.count; ++p) {
+            auto const& piece = blob.pieces[p];
+            skin.emplace(std::piecewise_construct,
+                         std::forward_as_tuple(blob.string(piece.name)),
+                         std::forward_as_tuple(skeleton::skin_piece{
+                             nullptr,
+                             box2f(vector2f(piece.min[0], piece.min[1]),
+                                   vector2f(piece.max[0], piece.max[1])),
+                             vector3f(piece.translate[0], piece.translate[1], 0.f),
+                             piece.rotation
+                         }));
+        }
+    }
+
+    for (uint32_t i = 0; i < head.slots; ++i) {
+        auto const& rec = blob.slots[i];
+        skel._slots.emplace(std::piecewise_construct,
+                            std::forward_as_tuple(blob.string(rec.name)),
+                            std::forward_as_tuple(rec.joint, rec.sprite, blob.string(rec.piece)));
+    }
+
+    for (uint32_t i = 0; i < head.clips; ++i) {
+        auto const& rec = blob.clips[i];
+        skel.add_clip(blob.string(rec.name), animation_clip::load_from(clip_view{blob, rec}));
+    }
+
+    if (head.default_skin != None) {
+        skel._default_skin = blob.string(head.default_skin);
+    }
+    return true;
+}
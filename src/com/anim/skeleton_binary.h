@@ -0,0 +1,136 @@
+#ifndef _CHAOS3D_COM_ANIM_SKELETON_BINARY_H
+#define _CHAOS3D_COM_ANIM_SKELETON_BINARY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class data_stream;
+
+namespace com {
+    class skeleton;
+
+    /// the precompiled binary format of the skeleton/animation data
+    ///
+    /// the blob is flat tables of fixed size records following the header,
+    /// in the order below, and a string table at the end. all records are
+    /// 4 bytes aligned and in the native byte order, so the blob can be read
+    /// in place (i.e. mapped memory) without parsing any text.
+    ///
+    ///   header
+    ///   joint_rec[joints]     parents always come before the children
+    ///   slot_rec[slots]
+    ///   skin_rec[skins]
+    ///   piece_rec[pieces]     skin pieces, grouped by the skin
+    ///   clip_rec[clips]
+    ///   channel_rec[channels] grouped by the clip
+    ///   track_rec[tracks]     keyframes of translate/scale/rotate channels
+    ///   float offsets[keys]   normalized key times, grouped by the track
+    ///   float values[values]  x/y for translate/scale, z/w for rotate
+    ///   uint16 words[words]   the compressed keys, as packed by the codec
+    ///   uint8 types[keys]     interpolation types
+    ///   char strings[]        '\0' terminated names
+    ///
+    /// the skeleton is 2D: translate z is 0, scale z is 1, and rotations are
+    /// about z only, so two floats are enough for a raw key. the compressed
+    /// tracks (see animation_clip::compress) are kept packed as they are,
+    /// keyframe_codec<>::words for each key.
+    class skeleton_binary {
+    public:
+        enum { Magic = 0x4b533343 /* C3SK */, Version = 2 };
+        enum { TrackTranslate, TrackScale, TrackRotate };
+        enum { Raw, Packed };        // the keys of the track
+        enum { None = 0xFFFFFFFF };  // no track/string
+
+        struct header {
+            uint32_t magic, version;
+            uint32_t joints, slots, skins, pieces;
+            uint32_t clips, channels, tracks, keys;
+            uint32_t values, words; // floats of the raw keys, words of the packed
+            uint32_t strings;       // size of the string table
+            uint32_t default_skin;  // string, or None
+        };
+
+        struct joint_rec {
+            uint32_t name;
+            int32_t parent;     // -1 for the root joints
+            float translate[2], scale[2], rotate[2];
+        };
+
+        struct slot_rec {
+            uint32_t name, joint, piece;
+            int32_t sprite;     // drawing order
+        };
+
+        struct skin_rec {
+            uint32_t name, first, count;
+        };
+
+        struct piece_rec {
+            uint32_t name;
+            float min[2], max[2], translate[2];
+            float rotation;
+        };
+
+        struct clip_rec {
+            uint32_t name, first, count;
+        };
+
+        struct channel_rec {
+            uint32_t name;
+            uint32_t translate, scale, rotate;  // track index or None
+        };
+
+        struct track_rec {
+            uint32_t first, count;  // keys
+            uint32_t wrap;
+            uint32_t codec;         // Raw or Packed
+            uint32_t data;          // first of the values or the words
+            float min[3], step[3];  // the vector codec, if packed
+        };
+
+        /// the tables of a blob, pointing into the memory
+        struct tables {
+            header const* head;
+            joint_rec const* joints;
+            slot_rec const* slots;
+            skin_rec const* skins;
+            piece_rec const* pieces;
+            clip_rec const* clips;
+            channel_rec const* channels;
+            track_rec const* tracks;
+            float const* offsets;
+            float const* values;
+            uint16_t const* words;
+            uint8_t const* types;
+            char const* strings;
+
+            char const* string(uint32_t offset) const { return strings + offset; }
+        };
+
+        /// to load one clip from the tables
+        struct clip_view {
+            tables const& blob;
+            clip_rec const& clip;
+        };
+
+    public:
+        /// check the stream starts with the binary magic, the stream
+        /// position is kept
+        static bool is_binary(data_stream*);
+
+        /// compile the loaded skeleton into the blob
+        static bool write(skeleton const&, std::vector<char>& blob);
+
+        /// load the skeleton from the blob in memory
+        static bool read(skeleton&, char const* data, size_t size);
+
+        /// the expected blob size from the header, in 64 bits not to wrap
+        static uint64_t blob_size(header const&);
+
+        /// point the tables into the blob, false if it is not valid
+        static bool map(char const* data, size_t size, tables&);
+    };
+}
+
+#endif
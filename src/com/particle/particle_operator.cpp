@@ -0,0 +1,148 @@
+#include "com/particle/particle_operator.h"
+#include <algorithm>
+
+using namespace com;
+
+#pragma mark - particle data
+
+void particle_data::set_capacity(size_t capacity) {
+    count = std::min(count, capacity);
+    position.conservativeResize(capacity, Eigen::NoChange);
+    velocity.conservativeResize(capacity, Eigen::NoChange);
+    color.conservativeResize(capacity, Eigen::NoChange);
+    color_delta.conservativeResize(capacity, Eigen::NoChange);
+    size.conservativeResize(capacity);
+    size_delta.conservativeResize(capacity);
+    life.conservativeResize(capacity);
+    life_rate.conservativeResize(capacity);
+}
+
+void particle_data::remove_dead() {
+    for (size_t i = 0; i < count;) {
+        if (life(i) > 0.f) {
+            ++ i;
+            continue;
+        }
+
+        // the order doesn't matter, the last one takes the place
+        size_t last = -- count;
+        if (i == last)
+            break;
+
+        position.row(i) = position.row(last);
+        velocity.row(i) = velocity.row(last);
+        color.row(i) = color.row(last);
+        color_delta.row(i) = color_delta.row(last);
+        size(i) = size(last);
+        size_delta(i) = size_delta(last);
+        life(i) = life(last);
+        life_rate(i) = life_rate(last);
+    }
+}
+
+void particle_random::fill(size_t count) {
+    if ((size_t)values.rows() < count)
+        values.resize(count);
+    stream.fill(values.data(), count);
+}
+
+#pragma mark - life
+
+void life_operator::set(float min, float max) {
+    _min_rate = min > 0.f ? 1.f / min : 1.f;
+    _max_rate = max > 0.f ? 1.f / max : 1.f;
+}
+
+void life_operator::spawn(particle_data& data, size_t first, size_t count,
+                          particle_random& random) const {
+    random.fill(count);
+    data.life.segment(first, count).setOnes();
+    data.life_rate.segment(first, count) = _max_rate + (_min_rate - _max_rate) * random.values.head(count);
+}
+
+void life_operator::update(particle_data& data, float delta) const {
+    auto n = data.count;
+    data.life.head(n) -= data.life_rate.head(n) * delta;
+}
+
+#pragma mark - color
+
+void color_operator::set(color_t const& start_lower, color_t const& start_upper,
+                         color_t const& end_lower, color_t const& end_upper) {
+    _start = start_lower, _start_range = start_upper - start_lower;
+    _end = end_lower, _end_range = end_upper - end_lower;
+}
+
+void color_operator::spawn(particle_data& data, size_t first, size_t count,
+                           particle_random& random) const {
+    // the life is normalized, so the delta reaches the end at death
+    random.fill(count);
+    for (int c = 0; c < 4; ++c)
+        data.color.col(c).segment(first, count) = _start[c] + _start_range[c] * random.values.head(count);
+
+    random.fill(count);
+    for (int c = 0; c < 4; ++c)
+        data.color_delta.col(c).segment(first, count) =
+            (_end[c] + _end_range[c] * random.values.head(count) - data.color.col(c).segment(first, count))
+            * data.life_rate.segment(first, count);
+}
+
+void color_operator::update(particle_data& data, float delta) const {
+    auto n = data.count;
+    data.color.topRows(n) += data.color_delta.topRows(n) * delta;
+}
+
+#pragma mark - size
+
+void size_operator::set(float start_lower, float start_upper,
+                        float end_lower, float end_upper) {
+    _start = start_lower, _start_range = start_upper - start_lower;
+    _end = end_lower, _end_range = end_upper - end_lower;
+}
+
+void size_operator::spawn(particle_data& data, size_t first, size_t count,
+                          particle_random& random) const {
+    random.fill(count);
+    data.size.segment(first, count) = _start + _start_range * random.values.head(count);
+
+    random.fill(count);
+    data.size_delta.segment(first, count) =
+        (_end + _end_range * random.values.head(count) - data.size.segment(first, count))
+        * data.life_rate.segment(first, count);
+}
+
+void size_operator::update(particle_data& data, float delta) const {
+    auto n = data.count;
+    data.size.head(n) += data.size_delta.head(n) * delta;
+}
+
+#pragma mark - force
+
+void force_operator::update(particle_data& data, float delta) const {
+    auto n = data.count;
+    for (int c = 0; c < 3; ++c)
+        data.velocity.col(c).head(n) += _force[c] * delta;
+}
+
+#pragma mark - point emitter
+
+void point_emitter::set(vector3f const& position,
+                        vector3f const& velocity_lower, vector3f const& velocity_upper) {
+    _position = position;
+    _velocity = velocity_lower, _velocity_range = velocity_upper - velocity_lower;
+}
+
+void point_emitter::spawn(particle_data& data, size_t first, size_t count,
+                          particle_random& random) const {
+    for (int c = 0; c < 3; ++c) {
+        data.position.col(c).segment(first, count).setConstant(_position[c]);
+
+        random.fill(count);
+        data.velocity.col(c).segment(first, count) = _velocity[c] + _velocity_range[c] * random.values.head(count);
+    }
+}
+
+void point_emitter::update(particle_data& data, float delta) const {
+    auto n = data.count;
+    data.position.topRows(n) += data.velocity.topRows(n) * delta;
+}
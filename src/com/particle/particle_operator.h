@@ -0,0 +1,122 @@
+#ifndef _CHAOS3D_COM_PARTICLE_PARTICLE_OPERATOR_H
+#define _CHAOS3D_COM_PARTICLE_PARTICLE_OPERATOR_H
+
+#include "common/base_types.h"
+#include "common/random.h"
+#include <cstddef>
+
+namespace com {
+
+    /// the particle states in structure-of-arrays
+    ///
+    /// each attribute is a column of its own (column major), so the
+    /// operators go through one attribute of all the particles at a time
+    /// with the Eigen arrays, which are vectorized. the live particles are
+    /// always packed in the first count rows.
+    struct particle_data {
+        typedef Eigen::Array<float, Eigen::Dynamic, 1> array1f_t;
+        typedef Eigen::Array<float, Eigen::Dynamic, 3> array3f_t; // x, y, z
+        typedef Eigen::Array<float, Eigen::Dynamic, 4> array4f_t; // r, g, b, a
+
+        array3f_t position, velocity;
+        array4f_t color, color_delta;   // per second
+        array1f_t size, size_delta;     // per second
+        array1f_t life, life_rate;      // normalized, 1 => 0 when it dies
+        size_t count = 0;
+
+        size_t capacity() const { return life.rows(); }
+
+        /// keep the live particles, drop the ones beyond
+        void set_capacity(size_t);
+
+        /// remove the dead particles by moving the last ones over
+        void remove_dead();
+    };
+
+    /// the random numbers to spawn: the stream of the system (seeded, so
+    /// the emitters replay the same) and the scratch of a batch
+    struct particle_random {
+        random_stream stream;
+        particle_data::array1f_t values;
+
+        /// uniform random numbers in [0, 1) for the spawned particles
+        void fill(size_t count);
+    };
+
+    // the operators: each one owns some of the attributes, initializes
+    // them for the spawned range [first, first + count) and updates all
+    // the live particles, one attribute array at a time.
+
+    /// the life span, it spawns first so the others can use the life rate
+    class life_operator {
+    public:
+        /// the life span in seconds, randomly in the range
+        void set(float min, float max);
+
+        void spawn(particle_data&, size_t first, size_t count, particle_random&) const;
+        void update(particle_data&, float delta) const;
+
+    private:
+        float _min_rate = 1.f, _max_rate = 1.f;
+    };
+
+    /// the color changing from the start to the end during the life
+    class color_operator {
+    public:
+        typedef vector4f color_t;
+
+        /// the start/end colors, randomly in the ranges
+        void set(color_t const& start_lower, color_t const& start_upper,
+                 color_t const& end_lower, color_t const& end_upper);
+
+        void spawn(particle_data&, size_t first, size_t count, particle_random&) const;
+        void update(particle_data&, float delta) const;
+
+    private:
+        color_t _start = color_t(1.f, 1.f, 1.f, 1.f), _start_range = color_t::Zero();
+        color_t _end = color_t::Zero(), _end_range = color_t::Zero();
+    };
+
+    /// the size changing from the start to the end during the life
+    class size_operator {
+    public:
+        /// the start/end sizes, randomly in the ranges
+        void set(float start_lower, float start_upper,
+                 float end_lower, float end_upper);
+
+        void spawn(particle_data&, size_t first, size_t count, particle_random&) const;
+        void update(particle_data&, float delta) const;
+
+    private:
+        float _start = 1.f, _start_range = 0.f;
+        float _end = 0.f, _end_range = 0.f;
+    };
+
+    /// the constant force (acceleration), i.e. gravity and wind
+    class force_operator {
+    public:
+        void set(vector3f const& force) { _force = force; }
+
+        void update(particle_data&, float delta) const;
+
+    private:
+        vector3f _force = vector3f::Zero();
+    };
+
+    /// emits from a point in the local space of the game object with the
+    /// velocity randomly in the box, and moves the particles
+    class point_emitter {
+    public:
+        void set(vector3f const& position,
+                 vector3f const& velocity_lower, vector3f const& velocity_upper);
+
+        void spawn(particle_data&, size_t first, size_t count, particle_random&) const;
+        void update(particle_data&, float delta) const;
+
+    private:
+        vector3f _position = vector3f::Zero();
+        vector3f _velocity = vector3f::Zero(), _velocity_range = vector3f::Zero();
+    };
+}
+
+#endif
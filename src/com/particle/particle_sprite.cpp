@@ -0,0 +1,142 @@
+#include "com/particle/particle_sprite.h"
+#include "com/particle/particle_system.h"
+#include "com/sprite2d/texture_atlas.h"
+#include "re/render_target.h"
+#include "sg/transform.h"
+#include "common/log.h"
+#include <algorithm>
+
+using namespace com;
+using namespace sprite2d;
+
+namespace {
+    uint32_t capacity_of(game_object* go) {
+        auto* ps = go->get_component<particle_system>();
+        uint32_t capacity = ps != nullptr ? ps->capacity() : 256;
+        if (capacity > particle_sprite::MaxCapacity) {
+            LOG_WARN(particle_sprite, "too many particles to draw, capped to " << particle_sprite::MaxCapacity);
+            capacity = particle_sprite::MaxCapacity;
+        }
+        return capacity;
+    }
+}
+
+particle_sprite::particle_sprite(game_object* go, int type, uint32_t capacity)
+: sprite(go, capacity * 4, type, stream_tag()), _capacity(capacity)
+{
+    _frame = {{
+        vector2f(0.f, 0.f), vector2f(0.f, 1.f),
+        vector2f(1.f, 0.f), vector2f(1.f, 1.f)
+    }};
+}
+
+particle_sprite::particle_sprite(game_object* go, int type)
+: particle_sprite(go, type, capacity_of(go))
+{
+}
+
+particle_sprite::particle_sprite(game_object* go, texture_atlas const& atlas,
+                                 std::string const& name,
+                                 std::string const& mat)
+: particle_sprite(go, sprite_mgr::position_uv) {
+    set_from_atlas(atlas, name, mat);
+}
+
+particle_sprite* particle_sprite::clone(game_object* go) const {
+    particle_sprite* ps = new particle_sprite(go, _data.buffer->type_idx, _capacity);
+    ps->_data.material = _data.material;
+    ps->_frame = _frame;
+    ps->mark_dirty();
+    return ps;
+}
+
+particle_sprite& particle_sprite::set_from_atlas(texture_atlas const& atlas, std::string const& name,
+                                                 std::string const& mat) {
+    set_material(mat, { make_uniform("c_tex1", atlas.texture_ptr().get()) });
+    set_frame(atlas.get_frame(name));
+    mark_dirty();
+    return *this;
+}
+
+void particle_sprite::generate_batch(render_target* target, size_t start, size_t count) const {
+    if (count > 0)
+        sprite::generate_batch(target, start, count);
+}
+
+void particle_sprite::fill_indices(uint16_t start_idx) {
+    // the stream is never moved, all the quads are laid out once
+    _indices.resize(_capacity * 6);
+    uint16_t* idx = _indices.data();
+    for (uint32_t i = 0; i < _capacity; ++i, idx += 6) {
+        uint16_t first = (uint16_t)(start_idx + i * 4);
+        idx[0] = first, idx[1] = first + 1, idx[2] = first + 2;
+        idx[3] = first + 1, idx[4] = first + 2, idx[5] = first + 3;
+    }
+}
+
+void particle_sprite::fill_buffer(vertex_layout::locked_buffer const& buffer,
+                                  com::transform const& trans) const {
+    auto* ps = parent()->get_component<particle_system>();
+    _live = ps != nullptr ? std::min((uint32_t)ps->particles().count, _capacity) : 0;
+    if (_live == 0)
+        return;
+
+    auto& data = ps->particles();
+    auto& affine = trans.global_affine();
+    size_t n = _live;
+
+    // all the centers at once, the corners are offset along the global axes
+    _centers.resize(n, Eigen::NoChange);
+    _centers.matrix() = data.position.topRows(n).matrix() * affine.linear().transpose();
+    _centers.rowwise() += affine.translation().transpose().array();
+    vector3f half_x = affine.linear().col(0) * .5f, half_y = affine.linear().col(1) * .5f;
+
+    auto& indices = _data.buffer->channel_indices;
+    if (indices[layout_buffer::POSITION] >= 0) {
+        char* raw = buffer.buffer(indices[layout_buffer::POSITION]);
+        assert(buffer.type(indices[layout_buffer::POSITION]) == vertex_layout::Float); // no conversion
+        size_t data_size = std::min(buffer.unit(indices[layout_buffer::POSITION]), 4) * sizeof(float);
+        size_t stride = buffer.stride(indices[layout_buffer::POSITION]);
+
+        for (size_t i = 0; i < n; ++i) {
+            vector3f center = _centers.row(i).transpose();
+            vector3f dx = half_x * data.size(i), dy = half_y * data.size(i);
+            float alpha = data.color(i, 3);
+            vector3f corners[] = {center - dx - dy, center - dx + dy, center + dx - dy, center + dx + dy};
+            for (auto& corner : corners) {
+                memcpy(raw, vector4f(corner.x(), corner.y(), corner.z(), alpha).data(), data_size);
+                raw += stride;
+            }
+        }
+    }
+
+    if (indices[layout_buffer::UV] >= 0) {
+        auto& uv = frame();
+        char* raw = buffer.buffer(indices[layout_buffer::UV]);
+        assert(buffer.type(indices[layout_buffer::UV]) == vertex_layout::Float); // no conversion
+        size_t data_size = std::min(buffer.unit(indices[layout_buffer::UV]), 2) * sizeof(float);
+        size_t stride = buffer.stride(indices[layout_buffer::UV]);
+
+        for (size_t i = 0; i < n; ++i) {
+            for (auto& corner : uv) {
+                memcpy(raw, corner.data(), data_size);
+                raw += stride;
+            }
+        }
+    }
+
+    if (indices[layout_buffer::COLOR] >= 0) {
+        char* raw = buffer.buffer(indices[layout_buffer::COLOR]);
+        assert(buffer.type(indices[layout_buffer::COLOR]) == vertex_layout::Float); // no conversion
+        size_t data_size = std::min(buffer.unit(indices[layout_buffer::COLOR]), 4) * sizeof(float);
+        size_t stride = buffer.stride(indices[layout_buffer::COLOR]);
+
+        for (size_t i = 0; i < n; ++i) {
+            vector4f color = data.color.row(i).transpose();
+            for (int c = 0; c < 4; ++c) {
+                memcpy(raw, color.data(), data_size);
+                raw += stride;
+            }
+        }
+    }
+}
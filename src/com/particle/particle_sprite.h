@@ -0,0 +1,64 @@
+#ifndef _CHAOS3D_COM_PARTICLE_PARTICLE_SPRITE_H
+#define _CHAOS3D_COM_PARTICLE_PARTICLE_SPRITE_H
+
+#include "com/sprite2d/sprite.h"
+#include "com/particle/particle_operator.h"
+#include "common/base_types.h"
+
+class texture_atlas;
+
+namespace com {
+    /// draws the particle_system of the same game object
+    ///
+    /// the particles are written straight into a stream vertex buffer of
+    /// its own as quads, facing the x/y plane of the game object, sized by
+    /// the particle size and tinted by its color (alpha goes to position.w
+    /// and the rest to the color channel if the layout has one). no sprite
+    /// nor game object for each particle, it's one batch per emitter.
+    class particle_sprite : public sprite2d::sprite {
+    public:
+        typedef std::array<vector2f, 4> sprite_v_t;
+
+        enum { MaxCapacity = 0xFFFF / 4 };   // 16 bits indices/count
+
+    public:
+        /// the capacity is taken from the particle system (added first)
+        particle_sprite(game_object*, int type = sprite2d::sprite_mgr::position_uv);
+        particle_sprite(game_object*, texture_atlas const&,
+                        std::string const& name,
+                        std::string const& mat = "basic");
+
+        /// the material and the frame of the texture for all the quads
+        particle_sprite& set_from_atlas(texture_atlas const&,
+                                        std::string const& name,
+                                        std::string const& mat = "basic");
+
+        /// the max particles to draw
+        uint32_t capacity() const { return _capacity; }
+
+        /// only the live quads
+        virtual std::tuple<const void*, uint32_t> index_data() const override {
+            return std::make_tuple(_indices.data(), _live * 6 * sizeof(uint16_t));
+        }
+
+        virtual void generate_batch(render_target*, size_t start, size_t count) const override;
+
+    protected:
+        virtual particle_sprite* clone(game_object*) const override;
+
+    private:
+        particle_sprite(game_object*, int type, uint32_t capacity);
+
+        virtual void fill_buffer(vertex_layout::locked_buffer const& buffer,
+                                 com::transform const&) const override;
+        virtual void fill_indices(uint16_t) override;
+
+        uint32_t _capacity;
+        mutable uint32_t _live = 0;                 // the quads filled
+        mutable particle_data::array3f_t _centers;  // scratch, global space
+
+        ATTRIBUTE(sprite_v_t, frame, sprite_v_t()); // texture uv, the whole by default
+    };
+}
+
+#endif
@@ -0,0 +1,144 @@
+#include "com/particle/particle_system.h"
+#include "com/sprite2d/sprite.h"
+#include "common/timer.h"
+#include <algorithm>
+
+using namespace com;
+
+#pragma mark - particle system
+
+particle_system::particle_system(game_object* go, uint32_t capacity)
+: component(go) {
+    _particles.set_capacity(capacity);
+    _random.stream.set_seed(particle_mgr::instance().next_seed());
+    particle_mgr::instance().add_system(this);
+}
+
+particle_system& particle_system::operator=(particle_system const& rhs) {
+    component::operator=(rhs);
+    _particles.set_capacity(rhs.capacity());
+    _emitter = rhs._emitter;
+    _life = rhs._life;
+    _color = rhs._color;
+    _size = rhs._size;
+    _force = rhs._force;
+    _rate = rhs._rate;
+    _active = rhs._active;
+    return *this;
+}
+
+void particle_system::destroy() {
+    _mark_for_remove = true;
+}
+
+particle_system& particle_system::emit(uint32_t count) {
+    spawn(count);
+    return *this;
+}
+
+particle_system& particle_system::clear() {
+    _particles.count = 0;
+    _pending = 0.f;
+    mark_dirty();
+    return *this;
+}
+
+particle_system& particle_system::set_capacity(uint32_t capacity) {
+    _particles.set_capacity(capacity);
+    return *this;
+}
+
+particle_system& particle_system::set_seed(uint32_t seed) {
+    _random.stream.set_seed(seed);
+    return *this;
+}
+
+particle_system& particle_system::set_life(float min, float max) {
+    _life.set(min, max);
+    return *this;
+}
+
+particle_system& particle_system::set_color(color_t const& start_lower, color_t const& start_upper,
+                                            color_t const& end_lower, color_t const& end_upper) {
+    _color.set(start_lower, start_upper, end_lower, end_upper);
+    return *this;
+}
+
+particle_system& particle_system::set_size(float start_lower, float start_upper,
+                                           float end_lower, float end_upper) {
+    _size.set(start_lower, start_upper, end_lower, end_upper);
+    return *this;
+}
+
+particle_system& particle_system::set_force(vector3f const& force) {
+    _force.set(force);
+    return *this;
+}
+
+particle_system& particle_system::set_emitter(vector3f const& position,
+                                              vector3f const& velocity_lower,
+                                              vector3f const& velocity_upper) {
+    _emitter.set(position, velocity_lower, velocity_upper);
+    return *this;
+}
+
+void particle_system::spawn(size_t count) {
+    auto first = _particles.count;
+    count = std::min(count, _particles.capacity() - first);
+    if (count == 0)
+        return;
+
+    // the life first, the color/size deltas depend on its rate
+    _emitter.spawn(_particles, first, count, _random);
+    _life.spawn(_particles, first, count, _random);
+    _color.spawn(_particles, first, count, _random);
+    _size.spawn(_particles, first, count, _random);
+    _particles.count += count;
+}
+
+void particle_system::update(float delta) {
+    auto live = _particles.count;
+    if (live > 0) {
+        _life.update(_particles, delta);
+        _color.update(_particles, delta);
+        _size.update(_particles, delta);
+        _force.update(_particles, delta);
+        _emitter.update(_particles, delta);
+        _particles.remove_dead();
+    }
+
+    if (_rate > 0.f) {
+        _pending += _rate * delta;
+        auto count = (size_t)_pending;
+        _pending -= count;
+        spawn(count);
+    }
+
+    if (live > 0 || _particles.count > 0)
+        mark_dirty();
+}
+
+void particle_system::mark_dirty() const {
+    // the sprite (i.e. particle_sprite) redraws from the data
+    if (sprite2d::sprite_mgr::flag_offset() != -1U)
+        parent()->set_flag(sprite2d::sprite_mgr::flag_offset());
+}
+
+#pragma mark - particle mgr
+
+void particle_mgr::add_system(particle_system* ps) {
+    _systems.emplace_back(ps);
+}
+
+void particle_mgr::pre_update(goes_t const&) {
+    _systems.erase(std::remove_if(_systems.begin(), _systems.end(), [] (system_ptr const& ps) {
+        return ps->_mark_for_remove;
+    }), _systems.end());
+
+    float delta = global_timer_base::has_created() ?
+        (float)global_timer_base::instance().recent_delta() : 0.f;
+    for (auto& it : _systems) {
+        if (it->_active)
+            it->update(delta);
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef _CHAOS3D_COM_PARTICLE_PARTICLE_SYSTEM_H
+#define _CHAOS3D_COM_PARTICLE_PARTICLE_SYSTEM_H
+
+#include "go/component.h"
+#include "com/particle/particle_operator.h"
+#include <memory>
+#include <vector>
+
+namespace com {
+    class particle_mgr;
+
+    /// the particle system component
+    ///
+    /// the particles are plain data (see particle_data), no game objects
+    /// nor components for each. they're simulated in the local space of the
+    /// game object by the fixed set of operators: emitter, life, color, size
+    /// and force, each of which goes through the whole arrays at once.
+    class particle_system : public component {
+    public:
+        typedef particle_mgr manager_t;
+        typedef vector4f color_t;
+
+    public:
+        particle_system(game_object*, uint32_t capacity = 256);
+
+        /// copy the settings, not the live particles
+        particle_system& operator=(particle_system const&);
+
+        /// spawn the particles at once, limited by the capacity
+        particle_system& emit(uint32_t count);
+
+        /// remove all the live particles
+        particle_system& clear();
+
+        /// the maximum live particles
+        particle_system& set_capacity(uint32_t);
+        uint32_t capacity() const { return (uint32_t)_particles.capacity(); }
+
+        // operator settings, see the operators
+        particle_system& set_life(float min, float max);
+        particle_system& set_color(color_t const& start_lower, color_t const& start_upper,
+                                   color_t const& end_lower, color_t const& end_upper);
+        particle_system& set_size(float start_lower, float start_upper,
+                                  float end_lower, float end_upper);
+        particle_system& set_force(vector3f const&);
+        particle_system& set_emitter(vector3f const& position,
+                                     vector3f const& velocity_lower,
+                                     vector3f const& velocity_upper);
+
+        /// restart the random sequence, the same seed spawns the same
+        particle_system& set_seed(uint32_t);
+
+        particle_data const& particles() const { return _particles; }
+
+    protected:
+        virtual void destroy() override;
+
+    private:
+        /// simulate for the elapsed time, and emit by the rate
+        void update(float delta);
+        void spawn(size_t count);
+        void mark_dirty() const;
+
+        particle_data _particles;
+        particle_random _random;        // seeded in the creation order
+        float _pending = 0.f;           // the fraction of the particles to emit
+
+        point_emitter _emitter;
+        life_operator _life;
+        color_operator _color;
+        size_operator _size;
+        force_operator _force;
+
+        bool _mark_for_remove = false;  // managed by particle_mgr
+
+        /// particles emitted per second
+        ATTRIBUTE(float, rate, 0.f);
+
+        /// whether to update at all
+        ATTRIBUTE(bool, active, true);
+
+        SIMPLE_CLONE(com::particle_system);
+        friend class particle_mgr;
+    };
+
+    /// update all the particle systems
+    class particle_mgr : public component_manager_base<particle_mgr> {
+    public:
+        typedef std::false_type component_fixed_t;
+        typedef std::unique_ptr<particle_system> system_ptr;
+        typedef std::vector<system_ptr> systems_t;
+
+    protected:
+        void add_system(particle_system*);
+        uint32_t next_seed() { return ++ _seeds; }
+
+        virtual void pre_update(goes_t const&) override;
+        virtual void update(goes_t const&) override {};
+
+    private:
+        systems_t _systems;
+        uint32_t _seeds = 0;
+
+        friend class particle_system;
+    };
+}
+
+#endif
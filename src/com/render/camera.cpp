@@ -6,15 +6,17 @@
 using namespace com;
 
 camera::camera(game_object* go, render_target* target_, int priority)
-: component(go), _priority(priority), _disabled(false),
-_viewport(Eigen::Vector2i{0, 0}, Eigen::Vector2i{256, 256}),
-_clear_color(.1f, .1f, .5f, 0.f),
+: component(go),
+_uniform(make_uniforms_ptr({
+    make_uniform<render_uniform::Mat4>("c_ProjViewMat", matrix4f::Identity())
+})),
+_proj_view(matrix4f::Identity()),
 _proj_view_inverse(matrix4f::Identity()),
 _proj_mat(matrix4f::Identity()),
 _proj_inverse(matrix4f::Identity()),
-_uniform(make_uniforms_ptr({
-    make_uniform<render_uniform::Mat4>("c_ProjViewMat", matrix4f::Identity())
-})){
+_viewport(Eigen::Vector2i{0, 0}, Eigen::Vector2i{256, 256}),
+_clear_color(.1f, .1f, .5f, 0.f),
+_disabled(false), _priority(priority) {
     camera_mgr::instance().add_camera(this);
     
     if (target_) {
@@ -29,6 +31,7 @@ camera::~camera() {
 camera& camera::operator=(camera const& rhs) {
     _proj_mat = rhs._proj_mat;
     _proj_inverse = rhs._proj_inverse;
+    _proj_view = rhs._proj_view;
     _proj_view_inverse = rhs._proj_view_inverse;
     _uniform = std::make_shared<render_uniform>(*rhs.uniform().get());
     _target = rhs._target->retain<render_target>();
@@ -49,6 +52,14 @@ camera::vector3f camera::unproject(vector3f const& pos) const {
     return vector3f(ret[0]/ret[3], ret[1]/ret[3], ret[2]/ret[3]);
 }
 
+bool camera::in_view(vector3f const& pos, float margin) const {
+    Eigen::Vector4f ret = _proj_view * Eigen::Vector4f{pos[0], pos[1], pos[2], 1.f};
+    float w = ret[3] * (1.f + margin);
+    return ret[3] > 0.f
+        && std::abs(ret[0]) <= w && std::abs(ret[1]) <= w
+        && std::abs(ret[2]) <= ret[3];
+}
+
 camera::ray camera::cast_from_screen(vector2f const& pos) const {
     vector3f p(_target->normalize_position({pos[0], pos[1], 0.f}, viewport()));
 	vector3f d(_target->normalize_position({pos[0], pos[1], 1.f}, viewport()));
@@ -129,11 +140,12 @@ void camera::update_matrix() {
     auto* trans = parent()->get_component<com::transform>();
     if (trans) {
         _proj_view_inverse = trans->global_affine().matrix() * _proj_inverse;
-        _uniform->set_matrix("c_ProjViewMat", matrix4f(_proj_mat * trans->global_inverse().matrix()));
+        _proj_view = _proj_mat * trans->global_inverse().matrix();
     } else {
         _proj_view_inverse = _proj_inverse;
-        _uniform->set_matrix("c_ProjViewMat", _proj_mat);
+        _proj_view = _proj_mat;
     }
+    _uniform->set_matrix("c_ProjViewMat", _proj_view);
 }
 
 camera& camera::set_perspective(float fovY, float aspect, float near, float far){
@@ -71,6 +71,10 @@ namespace com {
         // client(screen) space to the world space
         vector3f unproject(vector3f const&) const;
         
+        // whether the world position is inside the view frustum,
+        // the margin extends the view in normalized-device space
+        bool in_view(vector3f const&, float margin = 0.f) const;
+        
         // cast a ray from a screen point (a.k.a camera point)
         ray cast_from_screen(vector2f const&) const;
         
@@ -104,7 +108,7 @@ namespace com {
         
     private:
         render_uniform::ptr _uniform;
-        matrix4f _proj_view_inverse;
+        matrix4f _proj_view, _proj_view_inverse;
         matrix4f _proj_mat, _proj_inverse;
         render_target::ptr _target;
         renderables_t _renderables;
@@ -10,7 +10,10 @@ camera_mgr::~camera_mgr() {
     
 }
 
-void camera_mgr::update(const std::vector<game_object *> & goes) {
+void camera_mgr::update(const std::vector<game_object *> &) {
+}
+
+void camera_mgr::post_update(const std::vector<game_object *> & goes) {
     for (auto& it : _cameras) {
         if (it->disabled())
             continue;
@@ -33,6 +33,7 @@ namespace com {
         
     protected:
         virtual void update(std::vector<game_object*> const&) override;
+        virtual void post_update(std::vector<game_object*> const&) override;
         
         void add_renderable(renderable*);
     private:
@@ -1,6 +1,7 @@
 #include "com/scene2d/world_box2d.h"
 #include "sg/transform.h"
 #include "common/log.h"
+#include "common/timer.h"
 #include <Box2D/Box2D.h>
 
 using namespace scene2d;
@@ -253,14 +254,14 @@ void world2d_mgr::update(goes_t const& goes) {
     auto& world = _internal->world;
     auto offset = com::transform_manager::flag_offset();
     auto transform_idx = com::transform_manager::component_idx();
-    auto mark = goes.front()->mark();
+    auto const* root = &game_object::root();
     
     for (b2Body* first = world.GetBodyList(); first; first = first->GetNext()) {
         auto* collider = static_cast<collider2d*>(first->GetUserData());
         auto* obj = collider->parent();
         
         // deactivate the hidden objects
-        if (obj->mark() != mark) {
+        if (!obj->is_descendant_of(root)) {
             if (first->IsActive())
                 first->SetActive(false);
             continue;
@@ -287,7 +288,11 @@ void world2d_mgr::pre_update(goes_t const&) {
     auto& world = _internal->world;
     auto transform_idx = com::transform_manager::component_idx();
     
-    world.Step(_step, _velocity_iteration, _position_iteration);
+    // as many steps as the fixed steps of the global timer
+    timer::frame_t steps = global_timer_base::has_created() ?
+        global_timer_base::instance().fixed_steps() : 1;
+    for (timer::frame_t i = 0; i < steps; ++i)
+        world.Step(_step, _velocity_iteration, _position_iteration);
     
     for (b2Body* first = world.GetBodyList(); first; first = first->GetNext()) {
         if (!first->IsAwake())
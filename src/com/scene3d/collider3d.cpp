@@ -167,7 +167,7 @@ void world3d_mgr::update(goes_t const& goes) {
     auto& world = *_internal->world;
     auto offset = com::transform_manager::flag_offset();
     auto transform_idx = com::transform_manager::component_idx();
-    auto mark = goes.front()->mark();
+    auto const* root = &game_object::root();
     
     auto& objects = world.getCollisionObjectArray();
     for (int i = 0; i < objects.size(); ++i) {
@@ -176,7 +176,7 @@ void world3d_mgr::update(goes_t const& goes) {
         auto* go = collider->parent();
         
         // deactivate the hidden objects
-        if (go->mark() != mark) {
+        if (!go->is_descendant_of(root)) {
             if (object->isActive())
                 object->setActivationState(DISABLE_SIMULATION);
             continue;
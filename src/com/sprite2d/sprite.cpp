@@ -14,6 +14,11 @@ sprite::sprite(game_object* go, uint32_t count, int type)
     _data.buffer = sprite_mgr::instance().assign_buffer(this, count, type);
 }
 
+sprite::sprite(game_object* go, uint32_t count, int type, stream_tag)
+: component(go), _mark_for_remove(false) {
+    _data.buffer = sprite_mgr::instance().assign_stream(this, count, type);
+}
+
 sprite::~sprite() {
 }
 
@@ -213,6 +218,11 @@ void sprite_mgr::sort_sprites(const goes_t &gos) {
 void sprite_mgr::update(goes_t const& gos) {
     auto transform_idx = com::transform_manager::component_idx();
     
+    // the streams are dropped with their sprites
+    _streams.erase(std::remove_if(_streams.begin(), _streams.end(), [] (buffer_ptr const& it) {
+        return std::get<0>(it->sprites.front())->_mark_for_remove;
+    }), _streams.end());
+    
     // step 1: update all the indices, remove deleted sprites
     for (auto& it : _buffers) {
         //bool& update = it->need_update;
@@ -248,7 +258,7 @@ void sprite_mgr::update(goes_t const& gos) {
     auto sprite_flag = flag_offset();
     auto transform_flag = com::transform_manager::flag_offset();
     auto combined_flag = (1 << sprite_flag) | (3 << transform_flag);
-    for (auto& it : _buffers) {
+    auto update_vertices = [&] (layout_buffer* it) {
         // uses the first buffer
         // TODO: asynch locking?
         auto locked = it->layout->lock_channels();
@@ -284,6 +294,20 @@ void sprite_mgr::update(goes_t const& gos) {
         
         locked.unlock();
         //it->need_update = false;
+    };
+    
+    for (auto& it : _buffers)
+        update_vertices(it.get());
+    
+    for (auto& it : _streams) {
+        // a stream sprite is never moved, only locked/filled when dirty
+        auto& sprite = it->sprites.front();
+        auto* spt = std::get<0>(sprite).get();
+        if (std::get<3>(sprite) != std::get<1>(sprite))
+            spt->fill_indices(0);
+        else if ((spt->parent()->flag() & combined_flag) == 0)
+            continue;
+        update_vertices(it.get());
     }
 }
 
@@ -311,7 +335,8 @@ layout_buffer* sprite_mgr::assign_buffer(sprite* spt, uint32_t count, uint32_t t
     }
     
     if (buf == nullptr) {
-        buf = _buffers.emplace(it, create_buffer(_types[typeIdx]))->get();
+        buf = _buffers.emplace(it, create_buffer(_types[typeIdx], _vertex_buffer_size,
+                                                 _index_buffer_size, vertex_buffer::Dynamic))->get();
     }
     
     buf->type_idx = typeIdx;
@@ -323,6 +348,18 @@ layout_buffer* sprite_mgr::assign_buffer(sprite* spt, uint32_t count, uint32_t t
     return buf;
 }
 
+layout_buffer* sprite_mgr::assign_stream(sprite* spt, uint32_t count, uint32_t typeIdx) {
+    assert(spt->_data.buffer == nullptr);
+    
+    // 6 indices for each quad of 4 vertices
+    _streams.emplace_back(create_buffer(_types[typeIdx], count, count / 4 * 6,
+                                        vertex_buffer::Stream));
+    auto* buf = _streams.back().get();
+    buf->type_idx = typeIdx;
+    buf->sprites.emplace_back(spt, 0, count, -1U);
+    return buf;
+}
+
 uint32_t sprite_mgr::buffer_index(layout_buffer* buffer) const {
     auto found = std::find_if(_buffers.begin(), _buffers.end(), [=] (buffer_ptr const& ptr) {
         return ptr.get() == buffer;
@@ -331,7 +368,8 @@ uint32_t sprite_mgr::buffer_index(layout_buffer* buffer) const {
 }
 
 
-std::unique_ptr<layout_buffer> sprite_mgr::create_buffer(vertices_t const& layout) {
+std::unique_ptr<layout_buffer> sprite_mgr::create_buffer(vertices_t const& layout,
+                                                        size_t vsize, size_t isize, int usage) {
     vertex_layout::channels_t channels;
     channels.reserve(layout.size());
     
@@ -342,15 +380,14 @@ std::unique_ptr<layout_buffer> sprite_mgr::create_buffer(vertices_t const& layou
     }
     offset = (offset + 3) & ~(0x3); // align to multiple of 4 bytes
     
-    auto buffer = _device->create_buffer(_vertex_buffer_size * offset,
-                                         vertex_buffer::Dynamic);
+    auto buffer = _device->create_buffer(vsize * offset, usage);
     for (auto& it : channels) {
         it.buffer = buffer->retain<vertex_buffer>();
         it.stride = offset;
     }
     
     auto vlayout = _device->create_layout(std::move(channels),
-                                           _device->create_index_buffer(_index_buffer_size * sizeof(uint16_t),
+                                           _device->create_index_buffer(isize * sizeof(uint16_t),
                                                                         vertex_buffer::Stream),
                                            vertex_layout::Triangles);
     return make_unique<layout_buffer>(layout_buffer{std::move(vlayout), {}, 0, map_channel(layout)});
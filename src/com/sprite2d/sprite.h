@@ -131,14 +131,18 @@ namespace sprite2d {
             }
         };
         
+        // to own a dedicated stream buffer, see sprite_mgr::assign_stream
+        struct stream_tag {};
+        
     public:
         sprite(game_object*, uint32_t count /*number of vertices*/, int type/*layout*/);
+        sprite(game_object*, uint32_t count, int type, stream_tag);
         virtual ~sprite();
         
         void set_type(uint32_t count, int type);
         
         // buffer data
-        std::tuple<const void*, uint32_t> index_data() const {
+        virtual std::tuple<const void*, uint32_t> index_data() const {
             return std::make_tuple(_indices.data(), _indices.size() * sizeof(uint16_t));
         }
         
@@ -233,7 +237,7 @@ namespace sprite2d {
             int count;
             
             bool operator ==(sprite_vertex const& rhs) const {
-                return type == rhs.type && count == rhs.type && name == rhs.name;
+                return type == rhs.type && count == rhs.count && name == rhs.name;
             }
         };
         
@@ -271,6 +275,11 @@ namespace sprite2d {
         // note: the mgr will take over the ownership
         layout_buffer* assign_buffer(sprite*, uint32_t count, uint32_t typeIdx);
         uint32_t buffer_index(layout_buffer*) const;
+        
+        // a buffer of its own for the sprite with many vertices changing
+        // every frame (i.e. particles), the vertex buffer is streamed and
+        // sized to the count, so it can be filled in one go
+        layout_buffer* assign_stream(sprite*, uint32_t count, uint32_t typeIdx);
 
         // add a vertice layout/type, returned value to be used
         // to request the buffer
@@ -309,13 +318,15 @@ namespace sprite2d {
     private:
         template<class F>
         void update_buffer(layout_buffer&, F const&);
-        std::unique_ptr<layout_buffer> create_buffer(vertices_t const&);
+        std::unique_ptr<layout_buffer> create_buffer(vertices_t const&,
+                                                     size_t vsize, size_t isize, int usage);
         
     private:
         render_device* _device;
         std::array<std::string, layout_buffer::MAX> _channel_names;
         types_t _types;
         buffers_t _buffers;
+        buffers_t _streams;         // one sprite each
         materials_t _materials;
         size_t _vertex_buffer_size;
         size_t _index_buffer_size;
@@ -0,0 +1,43 @@
+#include "common/random.h"
+
+void random_stream::set_seed(uint64_t seed) {
+    _seed = seed;
+    _lane = 0;
+
+    // splitmix64 spreads the seed over the lanes, never all zeros
+    uint64_t x = seed;
+    for (uint32_t lane = 0; lane < Lanes; ++lane) {
+        for (uint32_t w = 0; w < 4; w += 2) {
+            uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            z ^= z >> 31;
+            _s[w][lane] = (uint32_t)z;
+            _s[w + 1][lane] = (uint32_t)(z >> 32);
+        }
+    }
+}
+
+void random_stream::fill(float* out, size_t count) {
+    // finish the started round, so the blocks start from the first lane
+    for (; count > 0 && _lane != 0; --count)
+        *out++ = next_float();
+
+    for (; count >= Lanes; count -= Lanes, out += Lanes) {
+        uint32_t* s0 = _s[0], *s1 = _s[1], *s2 = _s[2], *s3 = _s[3];
+        for (uint32_t lane = 0; lane < Lanes; ++lane) {
+            out[lane] = to_float(s0[lane] + s3[lane]);
+
+            uint32_t t = s1[lane] << 9;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = (s3[lane] << 11) | (s3[lane] >> 21);
+        }
+    }
+
+    for (; count > 0; --count)
+        *out++ = next_float();
+}
@@ -0,0 +1,72 @@
+#ifndef _CHAOS3D_RANDOM_H
+#define _CHAOS3D_RANDOM_H
+
+#include <cstdint>
+#include <cstddef>
+
+/// fast deterministic random numbers (xoshiro128+)
+///
+/// each user owns a stream of its own (i.e. a particle system, or a
+/// script), seeded explicitly, so the sequence is the same for the same
+/// seed and calls (replays), and there's no global state to contend for.
+///
+/// the state runs in 4 independent lanes laid out as structure-of-arrays,
+/// the batch fill steps all the lanes at once which is vectorized by the
+/// compiler; the single ones take the lanes in turn.
+class random_stream {
+public:
+    enum { Lanes = 4 };
+
+public:
+    explicit random_stream(uint64_t seed = 0) { set_seed(seed); }
+
+    /// restart the sequence from the seed
+    void set_seed(uint64_t);
+    uint64_t seed() const { return _seed; }
+
+    /// the raw 32 bits
+    uint32_t next() {
+        uint32_t lane = _lane;
+        _lane = (_lane + 1) & (Lanes - 1);
+        uint32_t result = _s[0][lane] + _s[3][lane];
+        step(lane);
+        return result;
+    }
+
+    /// uniform in [0, 1)
+    float next_float() { return to_float(next()); }
+
+    /// uniform in [lower, upper)
+    float uniform(float lower, float upper) { return lower + (upper - lower) * next_float(); }
+
+    /// uniform integer in [lower, upper]
+    int32_t uniform_int(int32_t lower, int32_t upper) {
+        uint64_t range = (uint64_t)((int64_t)upper - lower) + 1;
+        return (int32_t)(lower + (int64_t)((next() * range) >> 32));
+    }
+
+    /// fill the floats in [0, 1), in the blocks of the lanes
+    void fill(float* out, size_t count);
+
+private:
+    static float to_float(uint32_t v) {
+        // the upper 24 bits fit the mantissa
+        return (v >> 8) * (1.f / 16777216.f);
+    }
+
+    void step(uint32_t lane) {
+        uint32_t t = _s[1][lane] << 9;
+        _s[2][lane] ^= _s[0][lane];
+        _s[3][lane] ^= _s[1][lane];
+        _s[1][lane] ^= _s[2][lane];
+        _s[0][lane] ^= _s[3][lane];
+        _s[2][lane] ^= t;
+        _s[3][lane] = (_s[3][lane] << 11) | (_s[3][lane] >> 21);
+    }
+
+    uint32_t _s[4][Lanes];  // state word, lane
+    uint32_t _lane;         // the next lane for the single ones
+    uint64_t _seed;
+};
+
+#endif
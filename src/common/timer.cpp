@@ -1,5 +1,3 @@
 #include "common/timer.h"
 
-#ifdef __APPLE__
 const double timer::_tick_per_second = timer::tick_per_second();
-#endif
\ No newline at end of file
@@ -3,23 +3,20 @@
 
 #ifdef __APPLE__
 #include <mach/mach_time.h>
-#include <stdint.h>
+#else
+#include <chrono>
 #endif
-#include <ctime>
+#include <stdint.h>
 
 #include "common/utility.h"
 #include "common/singleton.h"
+#include "common/timer_wheel.h"
 
 class timer {
 public:
     typedef uint32_t frame_t;
     typedef double time_t;
-    
-#ifdef __APPLE__
     typedef uint64_t tick_t;
-#else
-    typedef clock_t tick_t;
-#endif
     
     // ticking using the given time
     class ticker_realtime {
@@ -38,27 +35,64 @@ public:
             return ticking(now);
         }
         
+        frame_t steps() const { return 1; }
+        float alpha() const { return 0.f; }
+        
     private:
         tick_t _last_tick;
     };
     
-    // ticking using the fixed ticks
+    // ticking in the fixed steps
+    // the real time is accumulated and consumed in whole steps, so the
+    // simulation steps deterministically; the remainder is the alpha for
+    // the rendering to interpolate. the steps are capped in each update,
+    // the time beyond is dropped instead of spiraling on slow frames.
+    // max_steps 0 is lockstep: one step for each update, whatever the real
+    // time passed (i.e. replays)
     class ticker_fixed {
     public:
-        ticker_fixed(frame_t frames = 30)
-        : _fixed_tick(_tick_per_second / (frames == 0 ? 30 : frames))
+        ticker_fixed(frame_t frames = 30, frame_t max_steps = 4,
+                     tick_t now = current())
+        : _fixed_tick(_tick_per_second / (frames == 0 ? 30 : frames)),
+        _max_steps(max_steps), _last_tick(now)
         {}
         
         tick_t ticking(tick_t now) {
-            return _fixed_tick;
+            if (_max_steps == 0) {
+                _steps = 1;
+                return _fixed_tick;
+            }
+            
+            _accumulated += now - _last_tick;
+            _last_tick = now;
+            
+            _steps = (frame_t)(_accumulated / _fixed_tick);
+            if (_steps > _max_steps) {
+                _accumulated = _accumulated % _fixed_tick + _max_steps * _fixed_tick;
+                _steps = _max_steps;
+            }
+            _accumulated -= _steps * _fixed_tick;
+            return _steps * _fixed_tick;
         }
         
         tick_t operator() (tick_t now) {
             return ticking(now);
         }
         
+        // the steps taken in the last ticking
+        frame_t steps() const { return _steps; }
+        
+        // the fraction of the next step elapsed, [0, 1)
+        float alpha() const {
+            return (float)((time_t)_accumulated / _fixed_tick);
+        }
+        
     private:
         tick_t _fixed_tick;
+        frame_t _max_steps;
+        frame_t _steps = 0;
+        tick_t _last_tick;
+        tick_t _accumulated = 0;
     };
 
 public:
@@ -85,40 +119,35 @@ public:
     
     // current tracking time
     time_t current_time() const {
-#ifdef __APPLE__
         return (time_t)_tick / _tick_per_second;
-#else
-        return (time_t)_tick / CLOCKS_PER_SEC;
-#endif
     }
     
     time_t recent_delta() const {
-#ifdef __APPLE__
         return (time_t)(_tick - _previous_tick) / _tick_per_second;
-#else
-        return (time_t)(_tick - _previous_tick) / CLOCKS_PER_SEC;
-#endif
     }
     
-    // current absolute time
+    // current absolute time, monotonic wall clock
     static tick_t current() {
 #ifdef __APPLE__
 		return mach_absolute_time();
 #else
-		return clock();
+		return (tick_t)std::chrono::steady_clock::now().time_since_epoch().count();
 #endif
 	};
 
 private:
-#ifdef __APPLE__
     static time_t tick_per_second() {
+#ifdef __APPLE__
         mach_timebase_info_data_t timebase_info;
         (void) mach_timebase_info(&timebase_info);
         return timebase_info.denom*1000000000L / timebase_info.numer;
+#else
+        typedef std::chrono::steady_clock::period period;
+        return (time_t)period::den / period::num;
+#endif
     }
 
     static const time_t _tick_per_second;
-#endif
     
 private:
     frame_t _current = 0;
@@ -129,6 +158,27 @@ private:
 class global_timer_base : public timer, public singleton<global_timer_base> {
 public:
     virtual void update() = 0;
+    
+    /// the deadlines driven by this timer, advanced in each update
+    timer_wheel& wheel() { return _wheel; }
+    
+    /// the fixed steps taken in the last update, the simulation would step
+    /// as many times (always 1 for the realtime ticker)
+    frame_t fixed_steps() const { return _steps; }
+    
+    /// the fraction of the next fixed step elapsed, for the rendering to
+    /// interpolate the simulated states
+    float alpha() const { return _alpha; }
+    
+    /// whether the timer is the global one, so its wheel can be used
+    static bool is_global(timer const& t) {
+        return has_created() && &t == &instance();
+    }
+    
+protected:
+    timer_wheel _wheel;
+    frame_t _steps = 1;
+    float _alpha = 0.f;
 };
 
 template<class T>
@@ -141,6 +191,9 @@ public:
     
     virtual void update() override {
         tick(_ticker(current()));
+        _steps = _ticker.steps();
+        _alpha = _ticker.alpha();
+        _wheel.advance(current_time());
     }
 private:
     T _ticker;
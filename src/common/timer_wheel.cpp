@@ -0,0 +1,167 @@
+#include "common/timer_wheel.h"
+#include <algorithm>
+#include <cmath>
+
+timer_wheel::timer_wheel(time_t resolution)
+: _heads(Slots + 1, Nil), _resolution(resolution > 0. ? resolution : 1e-3)
+{}
+
+timer_wheel::handle_t timer_wheel::schedule(time_t at, callback_t&& func) {
+    uint32_t idx = _free;
+    if (idx != Nil) {
+        _free = _nodes[idx].next;
+    } else {
+        idx = (uint32_t)_nodes.size();
+        _nodes.emplace_back();
+        _nodes.back().generation = 1;
+    }
+
+    node& n = _nodes[idx];
+    double tick = std::ceil(at / _resolution);
+    n.deadline = tick > 0. ? (tick_t)tick : 0;
+    n.func = std::move(func);
+    insert(idx);
+    ++ _count;
+    return ((handle_t)n.generation << 32) | idx;
+}
+
+bool timer_wheel::cancel(handle_t handle) {
+    uint32_t idx = index_of(handle);
+    if (idx == Nil)
+        return false;
+
+    unlink(idx);
+    release(idx);
+    return true;
+}
+
+bool timer_wheel::pending(handle_t handle) const {
+    return index_of(handle) != Nil;
+}
+
+void timer_wheel::advance(time_t now) {
+    _now = now;
+    tick_t target = now > 0. ? (tick_t)(now / _resolution) : 0;
+
+    while (_current <= target) {
+        if (_count == 0) {
+            // nothing to cascade or fire, catch up at once
+            _current = target + 1;
+            break;
+        }
+
+        uint32_t idx = _current & (RootSize - 1);
+        if (idx == 0) {
+            for (uint32_t level = 1; level < Levels && cascade(level); ++level);
+        }
+
+        // the ones scheduled by the callbacks go to the next ticks
+        ++ _current;
+        fire(idx);
+    }
+}
+
+uint32_t timer_wheel::index_of(handle_t handle) const {
+    uint32_t idx = (uint32_t)handle;
+    if (idx >= _nodes.size())
+        return Nil;
+
+    node const& n = _nodes[idx];
+    if (n.slot == Free || n.generation != (uint32_t)(handle >> 32))
+        return Nil;
+    return idx;
+}
+
+void timer_wheel::insert(uint32_t idx) {
+    static const tick_t range = (tick_t)1 << (RootBits + LevelBits * (Levels - 1));
+
+    // the passed ones are due in the current tick
+    tick_t deadline = std::max(_nodes[idx].deadline, _current);
+    tick_t delta = deadline - _current;
+
+    if (delta < RootSize) {
+        link(idx, deadline & (RootSize - 1));
+        return;
+    }
+
+    // beyond the range, park in the top level and re-insert on cascading
+    if (delta >= range) {
+        delta = range - 1;
+        deadline = _current + delta;
+    }
+
+    uint32_t level = 1, shift = RootBits;
+    while (delta >= ((tick_t)1 << (shift + LevelBits))) {
+        shift += LevelBits;
+        ++ level;
+    }
+
+    link(idx, RootSize + (level - 1) * LevelSize
+         + ((deadline >> shift) & (LevelSize - 1)));
+}
+
+void timer_wheel::link(uint32_t idx, uint32_t slot) {
+    node& n = _nodes[idx];
+    n.slot = slot;
+    n.prev = Nil;
+    n.next = _heads[slot];
+    if (n.next != Nil)
+        _nodes[n.next].prev = idx;
+    _heads[slot] = idx;
+}
+
+void timer_wheel::unlink(uint32_t idx) {
+    node& n = _nodes[idx];
+    if (n.prev != Nil)
+        _nodes[n.prev].next = n.next;
+    else
+        _heads[n.slot] = n.next;
+
+    if (n.next != Nil)
+        _nodes[n.next].prev = n.prev;
+}
+
+void timer_wheel::release(uint32_t idx) {
+    node& n = _nodes[idx];
+    n.func = nullptr;
+    n.slot = Free;
+    n.generation = (n.generation + 1) & GenerationMask;
+    if (n.generation == 0)
+        n.generation = 1;
+    n.next = _free;
+    _free = idx;
+    -- _count;
+}
+
+bool timer_wheel::cascade(uint32_t level) {
+    uint32_t shift = RootBits + (level - 1) * LevelBits;
+    uint32_t index = (_current >> shift) & (LevelSize - 1);
+    uint32_t slot = RootSize + (level - 1) * LevelSize + index;
+
+    uint32_t idx = _heads[slot];
+    _heads[slot] = Nil;
+    while (idx != Nil) {
+        uint32_t next = _nodes[idx].next;
+        insert(idx);
+        idx = next;
+    }
+
+    // the upper level turns as well
+    return index == 0;
+}
+
+void timer_wheel::fire(uint32_t slot) {
+    // move them aside, so the callbacks can schedule/cancel freely
+    uint32_t idx = _heads[slot];
+    _heads[slot] = Nil;
+    _heads[Firing] = idx;
+    for (; idx != Nil; idx = _nodes[idx].next)
+        _nodes[idx].slot = Firing;
+
+    while ((idx = _heads[Firing]) != Nil) {
+        unlink(idx);
+        callback_t func = std::move(_nodes[idx].func);
+        release(idx);
+        func();
+    }
+}
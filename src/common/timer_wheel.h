@@ -0,0 +1,101 @@
+#ifndef _CHAOS3D_TIMER_WHEEL_H
+#define _CHAOS3D_TIMER_WHEEL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/// hierarchical timing wheel for the deadlines
+///
+/// the time is divided into the ticks of the resolution; the pending
+/// timers are hashed into the slots by their deadlines: the first level has
+/// a slot per tick, and each upper level a slot per full turn of the level
+/// below. only the due slot is visited on each tick, and an upper slot is
+/// cascaded down once per turn, so the pending timers cost nothing until
+/// they're about to fire, no matter how many of them.
+///
+/// the global timer owns one (see global_timer_base::wheel) and drives it
+/// every frame. NB: main thread only
+class timer_wheel {
+public:
+    typedef double time_t;
+    typedef uint64_t tick_t;
+    typedef uint64_t handle_t;      // 0 for none
+    typedef std::function<void()> callback_t;
+
+    enum {
+        RootBits = 8,               // 256 ticks in the first level
+        LevelBits = 6,              // 64 slots for each upper level
+        Levels = 4,                 // ~18 hours in 1ms resolution
+    };
+
+public:
+    timer_wheel(time_t resolution = 1e-3);
+
+    /// call the function once the time reaches the given one, it's called
+    /// in the next advance if the time has passed already
+    handle_t schedule(time_t at, callback_t&& func);
+
+    /// call the function after the delay from the current time
+    handle_t schedule_after(time_t delay, callback_t&& func) {
+        return schedule(now() + delay, std::move(func));
+    }
+
+    /// remove a pending timer, false if it's fired/cancelled already
+    bool cancel(handle_t);
+
+    /// whether the timer is still pending
+    bool pending(handle_t) const;
+
+    /// move the time forward, firing the due timers in the deadline order
+    void advance(time_t now);
+
+    /// the time of the last advance
+    time_t now() const { return _now; }
+
+    /// the number of the pending timers
+    size_t size() const { return _count; }
+
+private:
+    enum : uint32_t {
+        Nil = 0xFFFFFFFF,
+        RootSize = 1 << RootBits,
+        LevelSize = 1 << LevelBits,
+        Slots = RootSize + LevelSize * (Levels - 1),
+        Firing = Slots,             // the slot being fired
+        Free = Slots + 1,           // not in any slot
+        GenerationMask = 0xFFFFF,   // keeps the handles exact in lua numbers
+    };
+
+    struct node {
+        tick_t deadline;
+        callback_t func;
+        uint32_t prev, next;
+        uint32_t slot;
+        uint32_t generation;
+    };
+
+    /// the node of a pending timer, or Nil
+    uint32_t index_of(handle_t) const;
+    void insert(uint32_t idx);
+    void link(uint32_t idx, uint32_t slot);
+    void unlink(uint32_t idx);
+    void release(uint32_t idx);
+
+    /// re-insert the timers of the upper level slot into the lower ones
+    bool cascade(uint32_t level);
+
+    /// fire the slot of the current tick
+    void fire(uint32_t slot);
+
+    std::vector<node> _nodes;
+    std::vector<uint32_t> _heads;   // slot => the first node, Firing last
+    uint32_t _free = Nil;           // free nodes linked by next
+    size_t _count = 0;
+    tick_t _current = 0;            // the next tick to process
+    time_t _now = 0;
+    time_t _resolution;
+};
+
+#endif
@@ -38,39 +38,53 @@ private:
         if(!go)
             return;
         
-        // TODO: cached the results
-        // TODO2: wrap with a collection result with helper functions
-        std::vector<game_object*> gos;
-        gos.reserve(game_object::number_of_objects());
+        // the dirty roots marked so far, managers can mark more
+        _gos.clear();
+        for(auto* it : game_object::dirty_roots()) {
+            if(it)
+                _gos.emplace_back(it);
+        }
         
-        go->pre_order(_active_mark++, [&](game_object const& go) {
-            // const cast here is fine since we would use it
-            // after processing
-            gos.emplace_back(const_cast<game_object*>(&go));
-        });
+        for(auto& it : _mgrs) {
+            it->pre_update(_gos);
+        }
         
-        if(gos.empty())
-            return;
+        // only the changed sub-trees are populated and updated
+        _gos.clear();
+        game_object::collect_dirty(go, _gos);
         
         for(auto& it : _mgrs) {
-            it->pre_update(gos);
+            it->update(_gos);
         }
-        
-        // the root won't have a parent
-        for(auto it = ++gos.begin(); it != gos.end(); ++it) {
-            (*it)->populate_flag();
+
+        // the renderers are given all the attached objects, which are
+        // only walked again once the hierarchy has changed
+        if(_root != go || _version != game_object::hierarchy_version()) {
+            _attached.clear();
+            _attached.reserve(game_object::number_of_objects());
+            go->pre_order(_active_mark++, [&](game_object const& go) {
+                // const cast here is fine since we would use it
+                // after processing
+                _attached.emplace_back(const_cast<game_object*>(&go));
+            });
+            _root = go;
+            _version = game_object::hierarchy_version();
         }
         
         for(auto& it : _mgrs) {
-            it->update(gos);
+            it->post_update(_attached);
         }
 
-        for(auto& it : gos) {
+        for(auto& it : _gos) {
             it->reset_flag();
         }
     };
     
     mgrs_t _mgrs;
+    component_manager::goes_t _gos; // the dirty objects of this frame
+    component_manager::goes_t _attached; // all the objects under the root
+    game_object* _root = nullptr;
+    uint32_t _version = 0;
     uint32_t _active_mark = 0;
 };
 
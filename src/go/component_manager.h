@@ -55,14 +55,16 @@ public:
     explicit component_manager(bool managed = true);
     virtual ~component_manager();
     
-    // frame loop
+    // frame loop, only the dirty objects (flags populated from
+    // their dirty parents) are given, parents before children
     virtual void update(goes_t const&) = 0;
     
     // before populating the flags, component managers can pre-
-    // populate changes
+    // populate changes; the dirty roots marked so far are given
     virtual void pre_update(goes_t const&) {};
     
-    // FIXME: Not implemented
+    // after the update, all the objects attached to the root are
+    // given, parents before children (i.e. for the renderers)
     virtual void post_update(goes_t const&) {};
     
     virtual void set_component_idx(uint32_t idx) = 0;
@@ -3,9 +3,17 @@
 #include <stack>
 
 uint32_t game_object::_number_of_objects = 0;
+uint32_t game_object::_hierarchy_version = 0;
 
 game_object::~game_object() {
     --_number_of_objects;
+    if (_dirty_idx != -1U)
+        dirty_list()[_dirty_idx] = nullptr;
+}
+
+std::vector<game_object*>& game_object::dirty_list() {
+    static std::vector<game_object*> _dirty_list;
+    return _dirty_list;
 }
 
 game_object::ptr game_object::clone() const {
@@ -22,6 +30,69 @@ void game_object::populate_flag() {
     _flag |= parent()->flag();
 }
 
+void game_object::populate_subtree(std::vector<game_object*>& gos) {
+    gos.emplace_back(this);
+    
+    // pre-order without a stack, the siblings of this are not visited
+    game_object* node = this;
+    for (;;) {
+        if (node->_first_child != null) {
+            node = node->_first_child;
+        } else {
+            while (node != this && node->_next_sibling == null)
+                node = node->_parent;
+            if (node == this)
+                break;
+            node = node->_next_sibling;
+        }
+        
+        node->populate_flag();
+        gos.emplace_back(node);
+    }
+}
+
+void game_object::collect_dirty(game_object* root, std::vector<game_object*>& gos) {
+    std::vector<game_object*> roots;
+    roots.swap(dirty_list());
+    for (auto* it : roots) {
+        if (it)
+            it->_dirty_idx = -1U;
+    }
+    
+    // only keep the top-most dirty roots, the others will be
+    // covered when populating their ancestors
+    auto last = roots.begin();
+    for (auto* it : roots) {
+        if (it == nullptr || it->flag() == 0)
+            continue;
+        
+        bool covered = false;
+        game_object const* top = it;
+        for (auto* node = it->parent(); node != nullptr; node = node->parent()) {
+            covered = covered || node->flag() != 0;
+            top = node;
+        }
+        
+        if (top != root) {
+            it->mark_dirty_root(); // not in the tree yet
+        } else if (!covered) {
+            *last++ = it;
+        }
+    }
+    
+    for (auto it = roots.begin(); it != last; ++it) {
+        (*it)->populate_subtree(gos);
+    }
+}
+
+bool game_object::is_descendant_of(game_object const* ancestor) const {
+    for (auto* node = this; node != nullptr; node = node->parent()) {
+        if (node == ancestor)
+            return true;
+    }
+    return false;
+}
+
 game_object* game_object::find_by_tag(char const* tag, bool recursive) const{
 	for (auto *child = _first_child;
         child != null; child = child->_next_sibling)
@@ -59,6 +130,7 @@ game_object& game_object::remove_if(const predicate_t &pred) {
             del->_parent = nullptr;
             del->_next_sibling = del->_pre_sibling = null;
             del->release();
+            ++_hierarchy_version;
         }
     }
     return *this;
@@ -144,6 +216,7 @@ game_object& game_object::add_child(game_object* child, game_object* after) {
 		_first_child = child;
     
     ++_child_size;
+    ++_hierarchy_version;
     return *this;
 }
 
@@ -166,6 +239,7 @@ game_object& game_object::remove_all() {
 	}
     
 	_first_child = null;
+    ++_hierarchy_version;
     return *this;
 }
 
@@ -184,6 +258,7 @@ void game_object::remove_self() {
     --_parent->_child_size;
 	_parent = nullptr;
     _next_sibling = _pre_sibling = null;
+    ++_hierarchy_version;
     release();
 }
 
@@ -200,6 +275,7 @@ game_object& game_object::move_upward() {
 	if (_pre_sibling == null)
 		_parent->_first_child = this;
     
+    ++_hierarchy_version;
     return *this;
 }
 
@@ -216,6 +292,7 @@ game_object& game_object::move_downward() {
 	if( _pre_sibling == 0 )
 		_parent->_first_child = this;
 
+    ++_hierarchy_version;
     return *this;
 }
 
@@ -234,6 +311,7 @@ game_object& game_object::move_top() {
 	last->_next_sibling = this;
 	_pre_sibling = last;
 	_next_sibling = null;
+    ++_hierarchy_version;
     return *this;
 }
 
@@ -8,6 +8,7 @@
 #include <string>
 #include <type_traits>
 #include <typeinfo>
+#include <vector>
 
 #include "common/referenced_count.h"
 #include "common/utility.h"
@@ -44,8 +45,9 @@ public:
     game_object(game_object* parent = &root(), char const* tag = nullptr)
     : _first_child(null), _parent(nullptr), _tag(tag ? tag : ""),
     _next_sibling(null), _pre_sibling(null), _child_size(0),
-    _flag(-1U){
+    _flag(-1U), _dirty_idx(-1U){
         ++ _number_of_objects;
+        mark_dirty_root();
         if (parent)
             parent->add_child(this);
     }
@@ -91,6 +93,9 @@ public:
     void for_each_child(iterator_t const&) const;
     void pre_order(uint32_t mark, iterator_t const&) const;
     void post_order(iterator_t const&) const;
+    
+    // whether it is in the sub-tree of the given ancestor
+    bool is_descendant_of(game_object const* ancestor) const;
 
     
     // get component - fixed version
@@ -203,13 +208,27 @@ public:
     }
     
     // change flag
+    // setting a flag records the object as a dirty root so only
+    // the changed sub-trees will be populated and updated
     uint32_t flag() const { return _flag; }
     void reset_flag() { _flag = 0; }
     void reset_flag(uint32_t offset, uint32_t mask = 1U) { _flag &= ~(mask << offset); }
-    void set_flag(uint32_t offset, uint32_t mask = 1U) { _flag |= mask << offset; }
+    void set_flag(uint32_t offset, uint32_t mask = 1U) { mark_dirty_root(); _flag |= mask << offset; }
     bool is_set(uint32_t offset, uint32_t mask = 1U) const { return (_flag & mask << offset) != 0; }
     void populate_flag(); // populate from the 'Parent'
     
+    // collect the dirty objects under the given root, populating the
+    // flags from each dirty root down to its sub-tree, parents first.
+    // dirty roots that are not attached to the root are kept for later
+    static void collect_dirty(game_object* root, std::vector<game_object*>&);
+    
+    // the objects whose flags have been set since the last collection
+    static std::vector<game_object*> const& dirty_roots() { return dirty_list(); }
+    
+    // bumped whenever a child is added, removed or moved, so a cached
+    // traversal only needs to be walked again after a change
+    static uint32_t hierarchy_version() { return _hierarchy_version; }
+    
     // --
     // some helper functions
     
@@ -225,12 +244,25 @@ public:
     }
     
     /// being set during transversal
-    /// this is used to check if the game object is in the active list
-    /// if the reference is kept somewhere else. the root object is
-    /// always active. @see world2d_mgr
+    /// this is used to check if the game object is in the visited list
+    /// if the reference is kept somewhere else.
     uint32_t mark() const { return _mark; }
 
 private:
+    static std::vector<game_object*>& dirty_list();
+    
+    void mark_dirty_root() {
+        if (_dirty_idx != -1U)
+            return;
+        auto& list = dirty_list();
+        _dirty_idx = static_cast<uint32_t>(list.size());
+        list.emplace_back(this);
+    }
+    
+    // populate the flag to all the descendants and collect them
+    void populate_subtree(std::vector<game_object*>&);
+    
+
     // no copy/assignment? use clone instead
     game_object(game_object const&) = delete;
     game_object& operator =(game_object const&) = delete;
@@ -241,12 +273,14 @@ private:
     size_t _child_size;
     
     uint32_t _flag;
+    uint32_t _dirty_idx; // index in the dirty list, -1 if not in
     mutable uint32_t _mark;
     
     components_t _components;
 
     constexpr static game_object* null = __builtin_constant_p((game_object*)0xFF) ? (game_object*)0xFF : (game_object*)0xFF; // diff than nullptr
     static uint32_t _number_of_objects;
+    static uint32_t _hierarchy_version;
     
     ATTRIBUTE(std::string, tag, "");
 };
@@ -0,0 +1,199 @@
+/* cHaos3D
+ *
+ * Copyright (C) 2009-2010 reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the license in the license sub-directory.
+ *
+ */
+
+#include "io/archive.h"
+#include "io/mapped_stream.h"
+#include "io/lz_codec.h"
+#include "common/log.h"
+#include <algorithm>
+#include <cstring>
+
+INHERIT_LOGGER(archive, data_stream);
+
+namespace {
+    // the stored entry read in place, holding the archive
+    class entry_stream : public memory_stream {
+    public:
+        entry_stream(archive::ptr const& owner, char const* address, size_t size)
+        : memory_stream(const_cast<char*>(address), size, false), _owner(owner)
+        {}
+        
+    private:
+        archive::ptr _owner;
+    };
+    
+    // the compressed entry decompressed on demand: the reads within the
+    // head (i.e. checking the signatures) are peeked, the whole entry is
+    // decompressed only when it's read past, and dropped again once it's
+    // read to the end or closed
+    class lazy_stream : public data_stream {
+    public:
+        enum { HeadSize = 64 };
+        
+        lazy_stream(archive::ptr const& owner, char const* data, archive_entry const& entry)
+        : _owner(owner), _data(data), _entry(entry)
+        {}
+        
+        virtual bool valid() override { return true; }
+        virtual bool end() override { return _current >= _entry.size; }
+        virtual long tell() override { return (long)_current; }
+        virtual size_t size() const override { return _entry.size; }
+        
+        virtual size_t read(void* buf, size_t size) override {
+            size = std::min(size, (size_t)_entry.size - _current);
+            char const* data = size > 0 ? fetch(_current + size) : nullptr;
+            if (data == nullptr)
+                return 0;
+            
+            memcpy(buf, data + _current, size);
+            _current += size;
+            if (_current == _entry.size)
+                _buffer.reset();
+            return size;
+        }
+        
+        virtual bool seek(long offset, int pos) override {
+            long base = pos == SeekCur ? (long)_current : pos == SeekEnd ? (long)_entry.size : 0;
+            if (base + offset < 0 || base + offset > (long)_entry.size)
+                return false;
+            _current = (size_t)(base + offset);
+            return true;
+        }
+        
+        virtual void close() override {
+            _buffer.reset();
+            _head_size = 0;
+        }
+        
+    private:
+        // the decompressed data up to the given size, null if corrupted
+        char const* fetch(size_t upto) {
+            if (_buffer)
+                return _buffer.get();
+            
+            if (upto <= HeadSize) {
+                if (_head_size == 0)
+                    _head_size = lz::peek(_data, _entry.packed_size, _head,
+                                          std::min((size_t)HeadSize, (size_t)_entry.size));
+                if (upto <= _head_size)
+                    return _head;
+            }
+            
+            _buffer.reset(new char[_entry.size]);
+            if (!lz::decompress(_data, _entry.packed_size, _buffer.get(), _entry.size)) {
+                LOG_ERROR(archive, "corrupted archive entry at " << _entry.offset);
+                _buffer.reset();
+            }
+            return _buffer.get();
+        }
+        
+        archive::ptr _owner;
+        char const* _data;
+        archive_entry _entry;
+        size_t _current = 0;
+        std::unique_ptr<char[]> _buffer;
+        char _head[HeadSize];
+        size_t _head_size = 0;
+    };
+    
+    int compare(char const* lhs, size_t lsize, char const* rhs, size_t rsize) {
+        int result = memcmp(lhs, rhs, std::min(lsize, rsize));
+        return result != 0 ? result : (lsize < rsize ? -1 : lsize > rsize);
+    }
+}
+
+archive::ptr archive::open(char const* filename) {
+    auto mapped = mapped_stream::open(filename);
+    if (!mapped)
+        return nullptr;
+    return open(std::move(mapped));
+}
+
+archive::ptr archive::open(std::unique_ptr<memory_stream>&& stream) {
+    std::shared_ptr<archive> pack(new archive(std::move(stream)));
+    if (!pack->validate())
+        return nullptr;
+    return pack;
+}
+
+archive::archive(std::unique_ptr<memory_stream>&& stream)
+: _stream(std::move(stream)) {
+}
+
+bool archive::validate() const {
+    size_t size = _stream->size();
+    if (size < sizeof(archive_header) || memcmp(header().magic, "C3PK", 4) != 0) {
+        LOG_ERROR("not an archive");
+        return false;
+    }
+    
+    auto& h = header();
+    if (h.version != archive_header::Version) {
+        LOG_ERROR("unsupported archive version: " << h.version);
+        return false;
+    }
+    
+    // the table and every entry fit in, so the lookups don't check
+    if (h.table > size || h.table % alignof(archive_entry) != 0 ||
+        (size - h.table) / sizeof(archive_entry) < h.count || h.names > size) {
+        LOG_ERROR("corrupted archive table");
+        return false;
+    }
+    
+    for (auto* it = entries(), *end = it + h.count; it != end; ++it) {
+        if ((uint64_t)h.names + it->name + it->name_size > size ||
+            (uint64_t)it->offset + it->packed_size > size ||
+            (it->codec == archive_entry::Stored && it->packed_size != it->size) ||
+            it->codec > archive_entry::LZ) {
+            LOG_ERROR("corrupted archive entry: " << name_of(*it));
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string archive::name_of(archive_entry const& entry) const {
+    return std::string(base() + header().names + entry.name, entry.name_size);
+}
+
+archive_entry const* archive::find(std::string const& name) const {
+    char const* names = base() + header().names;
+    auto* begin = entries(), *end = begin + header().count;
+    auto* it = std::lower_bound(begin, end, name, [names] (archive_entry const& entry, std::string const& name) {
+        return compare(names + entry.name, entry.name_size, name.data(), name.size()) < 0;
+    });
+    
+    if (it == end || compare(names + it->name, it->name_size, name.data(), name.size()) != 0)
+        return nullptr;
+    return it;
+}
+
+data_stream::ptr archive::from(archive_entry const& entry) const {
+    char const* data = base() + entry.offset;
+    if (entry.codec == archive_entry::Stored)
+        return data_stream::ptr(new entry_stream(shared_from_this(), data, entry.size));
+    
+    memory_stream::ptr stream(new memory_stream((size_t)entry.size));
+    if (!lz::decompress(data, entry.packed_size, stream->address(), entry.size)) {
+        LOG_ERROR("corrupted archive entry: " << name_of(entry));
+        return nullptr;
+    }
+    return std::move(stream);
+}
+
+data_stream::ptr archive::lazy(archive_entry const& entry) const {
+    if (entry.codec == archive_entry::Stored)
+        return from(entry);
+    return data_stream::ptr(new lazy_stream(shared_from_this(), base() + entry.offset, entry));
+}
+
+void archive::traverse(visitor_t const& visitor) const {
+    for (auto* it = entries(), *end = it + header().count; it != end; ++it)
+        visitor(name_of(*it), *it);
+}
@@ -0,0 +1,92 @@
+/* cHaos3D
+ *
+ * Copyright (C) 2009-2010 reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the license in the license sub-directory.
+ *
+ */
+
+#ifndef _CHAOS3D_IO_ARCHIVE_H
+#define _CHAOS3D_IO_ARCHIVE_H
+
+#include "io/memory_stream.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * the packed archive of the asset files (see editor/packer)
+ *  the whole file is mapped, the entries are found by the binary
+ *  search on the sorted table and read in place if they're stored,
+ *  or decompressed (see lz_codec.h) into a memory stream, on demand if
+ *  it is lazy
+ *
+ *  layout, little endian:
+ *      header      (archive_header)
+ *      data        each entry aligned to the header alignment
+ *      table       archive_entry, sorted by the names
+ *      names       not terminated, by the entry offset/size
+ */
+struct archive_header {
+    enum { Version = 1, Alignment = 16 };
+    
+    char magic[4];              // "C3PK"
+    uint32_t version;
+    uint32_t alignment;         // of the entry data
+    uint32_t count;             // number of the entries
+    uint32_t table;             // offset of the entries table
+    uint32_t names;             // offset of the names
+};
+
+struct archive_entry {
+    enum { Stored = 0, LZ = 1 };
+    
+    uint32_t name;              // offset/size into the names
+    uint32_t name_size;
+    uint32_t offset;            // of the data in the archive
+    uint32_t size;              // original
+    uint32_t packed_size;       // in the archive, the same if stored
+    uint32_t codec;
+};
+
+class archive : public std::enable_shared_from_this<archive> {
+public:
+    typedef std::shared_ptr<archive const> ptr;
+    typedef std::function<void(std::string const&, archive_entry const&)> visitor_t;
+    
+public:
+    /// map the archive, null if it's not valid
+    static ptr open(char const* filename);
+    
+    /// the archive in the memory, i.e. for the tests or the embedded one
+    static ptr open(std::unique_ptr<memory_stream>&&);
+    
+    /// find the entry, null if there isn't
+    archive_entry const* find(std::string const&) const;
+    
+    /// the stream of the entry, the stored ones refer to the archive in place
+    data_stream::ptr from(archive_entry const&) const;
+    
+    /// the stream of the entry decompressed only when it's read, and
+    /// released once it's read through, i.e. kept by the loaders
+    data_stream::ptr lazy(archive_entry const&) const;
+    
+    /// go through all the entries by the name order
+    void traverse(visitor_t const&) const;
+    
+    size_t count() const { return header().count; }
+    
+private:
+    archive(std::unique_ptr<memory_stream>&&);
+    
+    char const* base() const { return (char const*)_stream->address(); }
+    archive_header const& header() const { return *(archive_header const*)base(); }
+    archive_entry const* entries() const { return (archive_entry const*)(base() + header().table); }
+    std::string name_of(archive_entry const&) const;
+    bool validate() const;
+    
+    std::unique_ptr<memory_stream> _stream;   // kept by the stored entries
+};
+
+#endif
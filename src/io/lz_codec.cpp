@@ -0,0 +1,182 @@
+/* cHaos3D
+ *
+ * Copyright (C) 2009-2010 reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the license in the license sub-directory.
+ *
+ */
+
+#include "io/lz_codec.h"
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    enum {
+        HashBits = 12,
+        MinMatch = 4,
+        LastLiterals = 5,       // the block ends with the literals
+        MatchLimit = 12,        // the last match starts before this
+        MaxOffset = 0xFFFF,
+    };
+    
+    inline uint32_t read32(uint8_t const* p) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    
+    inline uint32_t hash(uint32_t seq) {
+        return (seq * 2654435761U) >> (32 - HashBits);
+    }
+    
+    // the length over 15 in the extra bytes
+    inline uint8_t* write_length(uint8_t* op, size_t len) {
+        for (; len >= 255; len -= 255)
+            *op++ = 255;
+        *op++ = (uint8_t)len;
+        return op;
+    }
+    
+    inline bool read_length(uint8_t const*& ip, uint8_t const* iend, size_t& len) {
+        uint8_t b;
+        do {
+            if (ip >= iend)
+                return false;
+            len += (b = *ip++);
+        } while (b == 255);
+        return true;
+    }
+}
+
+size_t lz::compress(char const* source, size_t size, char* dest, size_t capacity) {
+    uint8_t const* src = (uint8_t const*)source;
+    uint8_t const* ip = src, *anchor = src, *iend = src + size;
+    uint8_t* op = (uint8_t*)dest, *oend = op + capacity;
+    uint32_t table[1 << HashBits] = {0};
+    
+    // a sequence: the literals since the anchor, then the match
+    auto emit = [&] (size_t literals, size_t offset, size_t match) {
+        // token, the lengths, literals and offset, the worst case
+        if (op + 1 + literals + literals / 255 + 2 + match / 255 + 2 > oend)
+            return false;
+        
+        uint8_t* token = op++;
+        *token = (uint8_t)((literals < 15 ? literals : 15) << 4);
+        if (literals >= 15)
+            op = write_length(op, literals - 15);
+        if (literals > 0)
+            memcpy(op, anchor, literals);
+        op += literals;
+        
+        if (match >= MinMatch) {
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+            match -= MinMatch;
+            *token |= (uint8_t)(match < 15 ? match : 15);
+            if (match >= 15)
+                op = write_length(op, match - 15);
+        }
+        return true;
+    };
+    
+    if (size > MatchLimit) {
+        uint8_t const* mlimit = iend - MatchLimit;
+        uint8_t const* elimit = iend - LastLiterals;
+        while (ip < mlimit) {
+            uint32_t seq = read32(ip);
+            uint32_t h = hash(seq);
+            uint8_t const* ref = src + table[h];
+            table[h] = (uint32_t)(ip - src);
+            
+            if (ref >= ip || ip - ref > MaxOffset || read32(ref) != seq) {
+                ++ ip;
+                continue;
+            }
+            
+            size_t match = MinMatch;
+            while (ip + match < elimit && ref[match] == ip[match])
+                ++ match;
+            
+            if (!emit(ip - anchor, ip - ref, match))
+                return 0;
+            ip += match;
+            anchor = ip;
+        }
+    }
+    
+    if (!emit(iend - anchor, 0, 0))
+        return 0;
+    return op - (uint8_t*)dest;
+}
+
+namespace {
+    // decode until the output is full, it's corrupted if there is more
+    // unless it's only the prefix; the end of the output, null if corrupted
+    uint8_t* decode(uint8_t const* ip, uint8_t const* iend,
+                    uint8_t* dest, uint8_t* oend, bool prefix) {
+        uint8_t* op = dest;
+        
+        while (ip < iend) {
+            uint8_t token = *ip++;
+            size_t literals = token >> 4;
+            if (literals == 15 && !read_length(ip, iend, literals))
+                return nullptr;
+            if ((size_t)(iend - ip) < literals)
+                return nullptr;
+            if ((size_t)(oend - op) < literals) {
+                if (!prefix)
+                    return nullptr;
+                memcpy(op, ip, oend - op);
+                return oend;
+            }
+            if (literals > 0)
+                memcpy(op, ip, literals);
+            ip += literals, op += literals;
+            
+            // the last sequence has no match
+            if (ip == iend)
+                break;
+            
+            if (iend - ip < 2)
+                return nullptr;
+            size_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            if (offset == 0 || (size_t)(op - dest) < offset)
+                return nullptr;
+            
+            size_t match = token & 15;
+            if (match == 15 && !read_length(ip, iend, match))
+                return nullptr;
+            match += MinMatch;
+            if ((size_t)(oend - op) < match) {
+                if (!prefix)
+                    return nullptr;
+                match = oend - op;
+            }
+            
+            // it may overlap, byte by byte
+            uint8_t const* ref = op - offset;
+            for (size_t i = 0; i < match; ++i)
+                op[i] = ref[i];
+            op += match;
+            
+            if (prefix && op == oend)
+                break;
+        }
+        
+        return op;
+    }
+}
+
+bool lz::decompress(char const* source, size_t packed, char* dest, size_t size) {
+    uint8_t* oend = (uint8_t*)dest + size;
+    return decode((uint8_t const*)source, (uint8_t const*)source + packed,
+                  (uint8_t*)dest, oend, false) == oend;
+}
+
+size_t lz::peek(char const* source, size_t packed, char* dest, size_t size) {
+    uint8_t* op = decode((uint8_t const*)source, (uint8_t const*)source + packed,
+                         (uint8_t*)dest, (uint8_t*)dest + size, true);
+    return op != nullptr ? op - (uint8_t*)dest : 0;
+}
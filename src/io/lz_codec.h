@@ -0,0 +1,37 @@
+/* cHaos3D
+ *
+ * Copyright (C) 2009-2010 reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the license in the license sub-directory.
+ *
+ */
+
+#ifndef _CHAOS3D_IO_LZ_CODEC_H
+#define _CHAOS3D_IO_LZ_CODEC_H
+
+#include <cstddef>
+
+/// the LZ77 block codec in the LZ4 block format
+///
+/// fast to decode, (de)compresses a whole block in the memory, no
+/// framing nor checksum: the caller keeps the sizes (i.e. the archive
+/// entries, see archive.h)
+namespace lz {
+    /// the max compressed size of the given size
+    inline size_t bound(size_t size) { return size + size / 255 + 16; }
+    
+    /// compress into the dst, returns the compressed size or 0 if it
+    /// doesn't fit in the capacity
+    size_t compress(char const* src, size_t size, char* dst, size_t capacity);
+    
+    /// decompress exactly the size (the original) into the dst, false
+    /// if the data is corrupted
+    bool decompress(char const* src, size_t packed, char* dst, size_t size);
+    
+    /// decompress only the first size bytes at most, i.e. the headers,
+    /// returns the decompressed size, 0 if the data is corrupted
+    size_t peek(char const* src, size_t packed, char* dst, size_t size);
+}
+
+#endif
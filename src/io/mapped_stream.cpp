@@ -0,0 +1,46 @@
+/* cHaos3D
+ *
+ * Copyright (C) 2009-2010 reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the license in the license sub-directory.
+ *
+ */
+
+#include "io/mapped_stream.h"
+#include "common/log.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+INHERIT_LOGGER(mapped_stream, data_stream);
+
+mapped_stream::ptr mapped_stream::open(char const* filename) {
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR(mapped_stream, "Unable to open file:" << filename);
+        return nullptr;
+    }
+    
+    struct stat st;
+    void* address = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        address = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    
+    // the mapping stays after closing
+    ::close(fd);
+    if (address == MAP_FAILED)
+        return nullptr;
+    
+    LOG_INFO(mapped_stream, "Map file stream:" << filename);
+    return ptr(new mapped_stream((char*)address, (size_t)st.st_size));
+}
+
+mapped_stream::mapped_stream(char* address, size_t size)
+: memory_stream(address, size, false) {
+}
+
+mapped_stream::~mapped_stream() {
+    munmap(address(), size());
+}
@@ -0,0 +1,35 @@
+/* cHaos3D
+ *
+ * Copyright (C) 2009-2010 reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the license in the license sub-directory.
+ *
+ */
+
+#ifndef _CHAOS3D_IO_MAPPED_STREAM_H
+#define _CHAOS3D_IO_MAPPED_STREAM_H
+
+#include "io/memory_stream.h"
+
+/**
+ * data stream of a memory mapped file (read only)
+ *  as a memory stream, the loaders can read the mapping in place
+ *  by the address (see memory_stream::address), the pages are
+ *  loaded on demand by the system without copying or reading calls
+ */
+class mapped_stream : public memory_stream {
+public:
+    typedef std::unique_ptr<mapped_stream> ptr;
+    
+public:
+    /// map the whole file, null if it fails (i.e. empty file)
+    static ptr open(char const* filename);
+    
+    virtual ~mapped_stream();
+    
+private:
+    mapped_stream(char* address, size_t size);
+};
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "io/memory_stream.h"
 #include "common/log.h"
+#include <cstring>
 
 INHERIT_LOGGER(memory_stream, data_stream);
 
@@ -21,29 +22,21 @@ _owned(true)
         LOG_ERROR("Unable to allocate enough memory");
         return;
     }
-    LOG_DEBUG("Allocate for memory stream, " << ds->size() << " at 0x" << std::hex << this);
 
-    ds->read(_address, ds->size());
-    LOG_DEBUG("Initiazlie data from another stream, " << std::hex << ds);
-    _end = _address + ds->size();
+    _end = _address + ds->read(_address, ds->size());
 }
 
 memory_stream::memory_stream(const char* address, size_t size)
-: memory_stream(const_cast<char*>(address), // removing const won't hurt here...
-                size, true)
+: memory_stream(size)
 {
+    if (_address)
+        memcpy(_address, address, size);
 }
 
 memory_stream::memory_stream(char* address, size_t size, bool owned)
 : _address(address), _end(address + size), _current(address),
 _owned(owned)
 {
-    if (owned) {
-        LOG_DEBUG("Initiazlie data from another memory, " << std::hex << address);
-    } else {
-        LOG_DEBUG("Inialize memory stream with unmanaged memory at 0x" << std::hex << this
-                  << "from: 0x" << address);
-    }
 }
 
 memory_stream::memory_stream(size_t size)
@@ -55,7 +48,6 @@ _owned(true)
         LOG_ERROR("Unable to allocate enough memory");
         return;
     }
-    LOG_DEBUG("Allocate for memory stream, " << size << " at 0x" << std::hex << this);
     _end = _address + size;
     _current = _address;
 }
@@ -64,8 +56,6 @@ memory_stream::~memory_stream() {
     if (_owned && _address) {
         delete [] _address;
     }
-    LOG_DEBUG("Deallocate memory stream? " << (_owned ? "true" : "false")
-              << " at 0x" << std::hex << this);
     _address = nullptr;
 }
 
@@ -80,7 +70,7 @@ size_t memory_stream::read(void* buf, size_t bufSize){
 }
 
 bool memory_stream::end(){
-    return _current < _end;
+    return _current >= _end;
 }
 
 bool memory_stream::valid(){
@@ -112,14 +102,14 @@ long memory_stream::tell(){
 }
 
 memory_stream::ptr memory_stream::from(data_stream* ds, bool null_end) {
-    size_t size = ds->size() + (null_end ? 1 : 0);
-    char* buffer = new char[size];
-    
-    ds->read(buffer, size);
+    size_t size = ds->size();
+    char* buffer = new char[size + (null_end ? 1 : 0)];
     
+    size = ds->read(buffer, size);
     if (null_end) {
-        buffer[size - 1] = '\0';
+        buffer[size++] = '\0';
     }
     
-    return ptr(new memory_stream(buffer, size));
+    // the buffer is owned by the stream
+    return ptr(new memory_stream(buffer, size, true));
 }
@@ -1,20 +1,54 @@
 #include "loader/json/json_loader.h"
 #include "common/log.h"
-#include "io/data_stream.h"
+#include "io/memory_stream.h"
 #include <rapidjson/document.h>
+#include <algorithm>
+#include <cstring>
 
 using namespace rapidjson;
 
-class json_ds_wrapper {
+namespace {
+    // the rest of the stream in one buffer, null terminated for the in-situ
+    // parsing, read in large blocks rather than by the characters
+    std::unique_ptr<char[]> read_all(data_stream* ds) {
+        const size_t BlockSize = 64 * 1024;
+        
+        long start = std::max(ds->tell(), 0L);
+        size_t expected = ds->size() > (size_t)start ? ds->size() - start : 0;
+        size_t capacity = expected > 0 ? expected + 1 : BlockSize;
+        std::unique_ptr<char[]> buffer(new char[capacity]);
+        size_t size = 0;
+        
+        for (;;) {
+            size_t span = capacity - size - 1;
+            size_t read = ds->read(buffer.get() + size, span);
+            size += read;
+            
+            // grown only if there may be more, not for the end
+            if (read < span || size == expected || ds->end())
+                break;
+            
+            std::unique_ptr<char[]> larger(new char[capacity * 2]);
+            memcpy(larger.get(), buffer.get(), size);
+            buffer.swap(larger);
+            capacity *= 2;
+        }
+        
+        buffer[size] = '\0';
+        return buffer;
+    }
+}
+
+// reads the memory (i.e. mapped) in place, it's not null terminated
+class json_memory_wrapper {
 public:
-    json_ds_wrapper(data_stream* ds)
-    : _ds(ds) {
-        Read();
+    json_memory_wrapper(char const* begin, size_t size)
+    : _begin(begin), _current(begin), _end(begin + size) {
     }
     
-	char Peek() const { return _current; }
-	char Take() { char c = _current; Read(); return c; }
-	size_t Tell() const { return _ds->size(); }
+	char Peek() const { return _current < _end ? *_current : '\0'; }
+	char Take() { return _current < _end ? *_current++ : '\0'; }
+	size_t Tell() const { return _current - _begin; }
     
 	// Not implemented
 	void Put(char c) {  }
@@ -22,13 +56,9 @@ public:
 	size_t PutEnd(char*) { return 0; }
     
 private:
-    void Read() {
-        if (_ds->read(&_current, 1) == 0)
-            _current = '\0';
-    }
-    
-    data_stream* _ds;
-    char _current;
+    char const* _begin;
+    char const* _current;
+    char const* _end;
 };
 
 json_document::json_document(char const* str)
@@ -42,8 +72,17 @@ json_document::json_document(char const* str)
 json_document::json_document(data_stream* stream)
 : json_loader(new Document()) {
     Document& root = internal<Document>();
-    auto wrapper = json_ds_wrapper(stream);
-    if (root.ParseStream<0>(wrapper).HasParseError()) {
+    auto* mem = dynamic_cast<memory_stream*>(stream);
+    if (mem != nullptr) {
+        auto wrapper = json_memory_wrapper(mem->address() + mem->tell(), mem->size() - mem->tell());
+        root.ParseStream<0>(wrapper);
+    } else {
+        // the strings are kept in the buffer without copying
+        _buffer = read_all(stream);
+        root.ParseInsitu<0>(_buffer.get());
+    }
+    
+    if (root.HasParseError()) {
         LOG_ERROR("error loading json: " << root.GetParseError());
     }
 }
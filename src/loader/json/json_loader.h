@@ -29,7 +29,10 @@ private:
 class json_document : public json_loader {
 public:
     json_document(char const*);
-    json_document(data_stream*); // TODO: write rapidjson stream reader
+    
+    /// the memory streams (i.e. mapped) are parsed in place, the others
+    /// are read into a buffer at once and parsed in-situ
+    json_document(data_stream*);
     ~json_document();
     
     json_loader& as_json_loader() { return *this; }
@@ -38,6 +41,8 @@ private:
     json_document(json_document const&) = delete;
     json_document& operator=(json_document const&) = delete;
     json_document& operator=(json_document &&) = delete;
+    
+    std::unique_ptr<char[]> _buffer;    // the in-situ strings
 };
 
 #endif
\ No newline at end of file
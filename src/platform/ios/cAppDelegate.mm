@@ -17,6 +17,7 @@
 
 #import "script/state.h"
 #import "asset/asset_locator.h"
+#import "asset/asset_manager.h"
 #include <liblua/lua/lua.hpp>
 
 #if 0
@@ -68,6 +69,10 @@ static std::unique_ptr<script::coroutine> _main_coroutine(nullptr);
     component_manager::managers().update(&game_object::root());
     
     global_timer_base::instance().update();
+    
+    // the asynchronously loaded assets
+    if (global_asset_mgr::has_created())
+        global_asset_mgr::instance().update();
 }
 
 - (void)startLoop {
@@ -19,23 +19,45 @@
 #include "com/render/camera_mgr.h"
 #include "com/action/action.h"
 #include "com/anim/animation.h"
+#include "com/particle/particle_system.h"
 
 #include "asset/asset_manager.h"
 #include "asset/asset_locator.h"
 #include "asset/locator_asset_bundle.h"
 
 #include "asset_support/png_loader.h"
+#include "asset_support/raw_texture.h"
 
 //#include "asset_support/texture_asset.h"
 
 #include "common/timer.h"
 #include <array>
+#include <sys/stat.h>
 
 using namespace script;
 
 template class script::class_<native_window>;
 template class script::class_<render_device>;
 
+// fixed steps, one for each frame regardless of the real time
+static global_timer<timer::ticker_fixed>* make_lockstep_timer(timer::frame_t frames) {
+    return make_global_timer<timer::ticker_fixed>(frames, 0);
+}
+
+// the decoded textures with the mip levels (see png_loader), none if the
+// directory can't be made
+static std::string texture_cache_dir() {
+    auto home = locator::dir_locator::home_dir();
+    if (!home)
+        return std::string();
+    
+    std::string dir = home->name() + "texture_cache";
+    struct stat st;
+    if (stat(dir.c_str(), &st) != 0 && mkdir(dir.c_str(), 0755) != 0)
+        return std::string();
+    return dir;
+}
+
 static bool initialize_mgr(render_device* dev, render_context* ctx) {
     component_manager::initializer(
                                    make_manager<com::transform_manager>(),
@@ -44,6 +66,7 @@ static bool initialize_mgr(render_device* dev, render_context* ctx) {
                                    make_manager<sprite2d::sprite_mgr>(dev),
                                    make_manager<com::camera_mgr>(dev, ctx),
                                    make_manager<com::animation_mgr>(),
+                                   make_manager<com::particle_mgr>(),
                                    make_manager<com::action_mgr>()
                                    );
 
@@ -51,6 +74,7 @@ static bool initialize_mgr(render_device* dev, render_context* ctx) {
     asset_collection::context ast_ctx = {.scale = 2.f};
     auto& asset_mgr = global_asset_mgr::create({.scale = 2.f});
 
+    std::string cache_dir = texture_cache_dir();
     for (auto& it : {
         locator::dir_locator::app_dir(0, "/res"),
         locator::dir_locator::cur_dir(1, "/res"),
@@ -59,13 +83,16 @@ static bool initialize_mgr(render_device* dev, render_context* ctx) {
             continue;
 
         asset_bundle::loaders_t loaders;
-        loaders.emplace_front(new png_loader(dev));
+        png_loader* png = new png_loader(dev);
+        png->set_cache_dir(cache_dir);
+        loaders.emplace_front(png);
+        loaders.emplace_front(new raw_texture_loader(dev));
         
         asset_bundle::ptr bundle = asset_bundle::ptr(new locator_asset_bundle(it,
                                                                               std::move(loaders),
                                                                               ast_ctx));
 
-        asset_mgr.add_from_bundle(bundle.get());
+        asset_mgr.add_bundle(bundle);
     }
     return true;
 }
@@ -85,6 +112,7 @@ extern "C" void c3d_lua_import(lua_State *L) {
         {"init_mgr", LUA_BIND(&initialize_mgr)},
         {"create_realtime_timer", LUA_BIND(&make_global_timer<timer::ticker_realtime>)},
         {"create_fixed_timer", LUA_BIND((&make_global_timer<timer::ticker_fixed, timer::frame_t>))},
+        {"create_lockstep_timer", LUA_BIND(&make_lockstep_timer)},
         {NULL, NULL}
     };
     luaL_register(L, "chaos3d", funcs);
@@ -93,6 +121,7 @@ extern "C" void c3d_lua_import(lua_State *L) {
     .def_singleton_getter<sprite2d::sprite_mgr>("get_sprite_mgr")
     .def_singleton_getter<scene2d::world2d_mgr>("get_world2d_mgr")
     .def_singleton_getter<scene3d::world3d_mgr>("get_world3d")
+    .def_singleton_getter<com::animation_mgr>("get_animation_mgr")
     .def_singleton_getter<global_asset_mgr, asset_manager>("get_asset_mgr")
     .def_singleton_getter<locator_mgr>("get_locator")
     ;
@@ -106,6 +135,7 @@ extern "C" void c3d_lua_import(lua_State *L) {
     script::def_sprite2d(state.get(), "chaos3d");
     script::def_asset();
     script::def_action(state.get(), "chaos3d");
+    script::def_particle(state.get(), "chaos3d");
     script::def_event(state.get(), "chaos3d");
     script::def_stream(state.get(), "chaos3d");
 }
@@ -92,6 +92,10 @@
         component_manager::managers().update(&game_object::root());
         
         global_timer_base::instance().update();
+        
+        // the asynchronously loaded assets
+        if (global_asset_mgr::has_created())
+            global_asset_mgr::instance().update();
 
         return TRUE;
     }
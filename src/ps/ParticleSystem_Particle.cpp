@@ -1,30 +0,0 @@
-/* cHaos3D
- *
- * Copyright (C) 2009-2010 reserved.
- *
- * This program is free software; you can redistribute it and/or modify
- * it under the terms of the license in the license sub-directory.
- *
- */
-
-#include "ps/ps.h"
-#include "script/bind.h"
-
-//using namespace chaos;
-
-/*
-struct PointSpriteCollectionWrapper{
-	typedef PointSpriteCollection::PSRenderer<Particle> Renderer;
-	typedef PointSpriteCollection	Renderee;
-};
-*/
-/*
-IMPLEMENT_SPEC( PA_plcs, PA_plcs, 0, LIB_DOMAIN)
-IMPLEMENT_FACTORY( (LuaRefFactory<PA_plcs>) )
-//IMPLEMENT_FUNC( animation, (&PA_plcs::animation<Particle, PointSpriteCollectionWrapper>) )
-IMPLEMENT_PROP( life, 0, (&PA_plcs::operator_<1>) )
-IMPLEMENT_PROP( color, 0, (&PA_plcs::operator_<2>) )
-IMPLEMENT_PROP( size, 0, (&PA_plcs::operator_<3>) )
-IMPLEMENT_PROP( force, 0, (&PA_plcs::operator_<4>) )
-IMPLEMENT_END;
-*/
\ No newline at end of file
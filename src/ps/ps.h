@@ -1,14 +0,0 @@
-/* cHaos3D
- *
- * Copyright (C) 2009-2010 reserved.
- *
- * This program is free software; you can redistribute it and/or modify
- * it under the terms of the license in the license sub-directory.
- *
- */
-
-#include "ParticleSystem.h"
-
-#include "ParticleGenericOperator.h"
-#include "ParticleEmitterOperator.h"
-//#include "ParticleApplierOperator.h"
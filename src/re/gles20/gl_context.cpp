@@ -1,4 +1,5 @@
 #include <typeinfo>
+#include <algorithm>
 
 #include "re/gles20/gl_context.h"
 #include "re/gles20/gl_gpu.h"
@@ -22,15 +23,54 @@ static GLenum _blend_func_map [] = {
     GL_ONE_MINUS_DST_ALPHA,	GL_ONE_MINUS_SRC_ALPHA
 };
 
+static GLenum _blend_op_map [] = {
+    GL_FUNC_ADD, GL_FUNC_SUBTRACT, GL_FUNC_REVERSE_SUBTRACT,
+};
+
+static GLenum _cull_face_map [] = {
+    0, // CullNone
+    GL_FRONT, GL_BACK, GL_FRONT_AND_BACK,
+};
+
 void gl_context::apply() {
-    render_state const& cur = _cur_state;
-    render_state const& bound = _bound_state;
+    // textures created or uploaded are bound directly to the active
+    // unit, its shadow is no longer known
+    auto generation = gles20::gl_texture::bind_generation();
+    if(generation != _bind_generation) {
+        _bind_generation = generation;
+        if(_active_unit >= 0) {
+            _bound_ids[_active_unit] = UnknownId;
+            _dirty_textures |= 1u << _active_unit;
+        }
+    }
+    
+    // a swapped texture keeps its pointer with another id, and a
+    // deleted id is unbound from every unit, check them all again
+    generation = gles20::gl_texture::id_generation();
+    if(generation != _id_generation) {
+        _id_generation = generation;
+        std::fill(_bound_ids.begin(), _bound_ids.end(), (uint32_t)UnknownId);
+        _dirty_textures = _textures.empty() ? 0 : (~0u >> (sizeof(_dirty_textures) * 8 - _textures.size()));
+    }
     
-    //TODO: add to the state
-    glDisable(GL_CULL_FACE);
-    glFrontFace(GL_CCW);
+    if(_dirty_state != 0) {
+        apply_state(_dirty_state);
+        _bound_state = _cur_state;
+        _dirty_state = 0;
+    }
+    
+    if(_dirty_textures != 0) {
+        apply_textures(_dirty_textures);
+        _dirty_textures = 0;
+    }
     
-    if(cur.depth_func() != bound.depth_func()) {
+    _invalid_state = 0;
+}
+
+void gl_context::apply_state(uint32_t dirty) {
+    render_state const& cur = _cur_state;
+    
+    if(dirty & render_state::DirtyDepth) {
         if(cur.depth_func() == render_state::DepthNone) {
             glDisable(GL_DEPTH_TEST);
         } else {
@@ -40,15 +80,8 @@ void gl_context::apply() {
         GLNOERROR;
     }
 
-    if(cur.src_blend() != bound.src_blend()
-       || cur.dst_blend() != bound.dst_blend()
-       || cur.src_alpha_blend() != bound.src_alpha_blend()
-       || cur.dst_alpha_blend() != bound.dst_alpha_blend()
-       ){
-        if(cur.src_blend() == render_state::BlendNone
-           || cur.dst_blend() == render_state::BlendNone
-           || cur.src_alpha_blend() == render_state::BlendNone
-           || cur.dst_alpha_blend() == render_state::BlendNone) {
+    if(dirty & render_state::DirtyBlendFunc) {
+        if(cur.blend_disabled()) {
             glDisable(GL_BLEND);
         } else {
             glEnable(GL_BLEND);
@@ -60,43 +93,59 @@ void gl_context::apply() {
         GLNOERROR;
     }
     
-    if(cur.blend_color() != bound.blend_color())
+    if(dirty & render_state::DirtyBlendOp) {
+        glBlendEquationSeparate(_blend_op_map[cur.blend_op()],
+                                _blend_op_map[cur.alpha_blend_op()]);
+        GLNOERROR;
+    }
+    
+    if(dirty & render_state::DirtyBlendColor) {
         glBlendColor(cur.blend_color()[0], cur.blend_color()[1], cur.blend_color()[2], cur.blend_color()[3]);
+        GLNOERROR;
+    }
     
-    int unit = 0;
-    auto bound_it = _bound_textures.begin();
-    for(auto it = _textures.begin(); it != _textures.end();
-        ++bound_it, ++unit, ++it) {
-        if(it->get() == bound_it->get())
+    if(dirty & render_state::DirtyCulling) {
+        if(cur.culling() == render_state::CullNone) {
+            glDisable(GL_CULL_FACE);
+        } else {
+            glEnable(GL_CULL_FACE);
+            glCullFace(_cull_face_map[cur.culling()]);
+        }
+        
+        // the winding is fixed, only set it up once
+        if(_invalid_state & render_state::DirtyCulling)
+            glFrontFace(GL_CCW);
+        GLNOERROR;
+    }
+}
+
+void gl_context::apply_textures(uint32_t dirty) {
+    for(int unit = 0; dirty != 0; ++unit, dirty >>= 1) {
+        if((dirty & 1) == 0)
             continue;
         
-        glActiveTexture(GL_TEXTURE0 + unit);
-        if(*it == nullptr) {
-            glDisable(GL_TEXTURE_2D); // FIXME: texture type
-        } else {
-            glBindTexture(GL_TEXTURE_2D, static_cast<gles20::gl_texture const*>(it->get())->tex_id());
+        auto const& tex = _textures[unit];
+        auto& bound = _bound_textures[unit];
+        uint32_t tex_id = tex == nullptr ? 0 : static_cast<gles20::gl_texture const*>(tex.get())->tex_id();
+        if(bound.get() != tex.get())
+            bound = tex == nullptr ? texture::const_ptr() : tex->retain<texture>();
+        if(tex_id == _bound_ids[unit] && _invalid_state == 0)
+            continue;
         
-            // TODO: texture parameters
+        if(_active_unit != unit) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            _active_unit = unit;
         }
+        
+        // FIXME: texture type
+        // TODO: texture parameters
+        glBindTexture(GL_TEXTURE_2D, tex_id);
+        _bound_ids[unit] = tex_id;
         GLNOERROR;
     }
-    
-    glActiveTexture(GL_TEXTURE0);
-    _bound_state = _cur_state;
-    std::transform(_textures.begin(), _textures.end(), _bound_textures.begin(), [](texture::const_ptr &t) {
-        return t.get() ? t->retain<texture>() : std::move(t);
-    });
-    GLNOERROR;
-
-    //_bound_textures = std::move(_textures);
 }
 
 #pragma mark - move up
-bool gl_context::set_state(render_state const&state) {
-    _cur_state = state;
-    return true;
-}
-
 bool gl_context::set_program(gpu_program const& program) {
     assert(typeid(program) == typeid(gl_gpu_program));
     return true;
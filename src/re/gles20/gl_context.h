@@ -6,12 +6,22 @@
 class gl_context : public render_context {
 public:
     gl_context(size_t max)
-    : render_context(max)
+    : render_context(max), _bound_ids(max, UnknownId)
     {}
     
-    virtual bool set_state(render_state const&) override;
     virtual bool set_program(gpu_program const&) override;
     virtual void apply() override;
+    
+private:
+    enum { UnknownId = ~0u };
+    
+    void apply_state(uint32_t dirty);
+    void apply_textures(uint32_t dirty);
+    
+    int _active_unit = -1; // the shadowed active texture unit
+    std::vector<uint32_t> _bound_ids; // the shadowed texture ids per unit
+    uint32_t _bind_generation = 0; // of the textures bound directly
+    uint32_t _id_generation = 0; // of the texture ids deleted or swapped
 };
 
 #endif
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "re/gles20/gl_texture.h"
 #include "io/memory_stream.h"
+#include <algorithm>
 
 #include <EGL/egl.h>
 #include <GLES2/gl2ext.h>
@@ -21,6 +22,7 @@ static GLenum _color_map_storage [] = {
     GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG, //PRVTC2_RGB
     GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG,//PVRTC4_RGBA
     GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG,//PVRTC2_RGBA
+    GL_RGBA4,        //RGBA4444
 };
 
 static GLenum _color_map [] = {
@@ -32,6 +34,16 @@ static GLenum _color_map [] = {
     GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG, //PRVTC2_RGB
     GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG,//PVRTC4_RGBA
     GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG,//PVRTC2_RGBA
+    GL_RGBA,        //RGBA4444
+};
+
+static GLenum _pixel_type_map [] = {
+    GL_UNSIGNED_BYTE,           //RGBA8888,
+    GL_UNSIGNED_SHORT_5_6_5,    //RGB565,
+    GL_UNSIGNED_BYTE,           //ALPHA,
+    GL_UNSIGNED_BYTE,           //LUMINANCE
+    0, 0, 0, 0,                 //PVRTC
+    GL_UNSIGNED_SHORT_4_4_4_4,  //RGBA4444
 };
 
 static GLenum _filter_map [] = {
@@ -45,18 +57,23 @@ static GLenum _wrap_map [] = {
     GL_MIRRORED_REPEAT,
 };
 
+std::atomic<uint32_t> gl_texture::_bind_generation(0);
+std::atomic<uint32_t> gl_texture::_id_generation(0);
+
 gl_texture::gl_texture(texture::vector2i const& size, texture::attribute_t const& attr)
 : texture(size, attr){
     glGenTextures(1, &_tex_id);
-    glBindTexture(_type_map[attr.type], _tex_id);
+    bind(_type_map[attr.type]);
     
     if (glTexStorage2DEXT != nullptr) {
         glTexStorage2DEXT(_type_map[attr.type], attr.mipmap,
                           _color_map_storage[attr.color], size[0], size[1]);
     } else {
-        // FIXME: allocate mipmaps/compressed data
-        glTexImage2D(_type_map[attr.type], 0, _color_map[attr.color],
-                     size[0], size[1], 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        // FIXME: allocate compressed data
+        for (int level = 0; level < attr.mipmap; ++level)
+            glTexImage2D(_type_map[attr.type], level, _color_map[attr.color],
+                         std::max(size[0] >> level, 1), std::max(size[1] >> level, 1), 0,
+                         _color_map[attr.color], _pixel_type_map[attr.color], NULL);
     }
     
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _filter_map[attr.min_filter]);
@@ -70,52 +87,70 @@ gl_texture::gl_texture(texture::vector2i const& size, texture::attribute_t const
 
 gl_texture::~gl_texture() {
     glDeleteTextures(1, &_tex_id);
+    ++_id_generation;
+}
+
+void gl_texture::bind(GLenum target) const {
+    glBindTexture(target, _tex_id);
+    ++_bind_generation;
+}
+
+void gl_texture::swap(texture& other) {
+    texture::swap(other);
+    std::swap(_tex_id, static_cast<gl_texture&>(other)._tex_id);
+    ++_id_generation;
 }
 
 bool gl_texture::generate_mipmap() {
     GLenum target = _type_map[attribute().type];
-    glBindTexture(target, _tex_id);    
+    bind(target);
     glGenerateMipmap(target);
     return glGetError() == GL_NO_ERROR;
 }
 
 bool gl_texture::load(memory_stream* stream, int color, int level) {
     GLenum target = _type_map[attribute().type];
-    glBindTexture(target, _tex_id);
+    bind(target);
 
-    // TODO: fix width based on mipmap level
+    GLsizei width = std::max(size()[0] >> level, 1), height = std::max(size()[1] >> level, 1);
     switch (color) {
         case RGBA8888:
-            glTexSubImage2D(target, level, 0, 0, size()[0], size()[1],
+            glTexSubImage2D(target, level, 0, 0, width, height,
                             GL_RGBA, GL_UNSIGNED_BYTE, stream->address());
             break;
         case RGB565:
-            glTexSubImage2D(target, level, 0, 0, size()[0], size()[1],
+            glTexSubImage2D(target, level, 0, 0, width, height,
                             GL_RGB, GL_UNSIGNED_SHORT_5_6_5, stream->address());
             break;
+        case RGBA4444:
+            glTexSubImage2D(target, level, 0, 0, width, height,
+                            GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, stream->address());
+            break;
         case ALPHA:
-            glTexSubImage2D(target, level, 0, 0, size()[0], size()[1],
+            glTexSubImage2D(target, level, 0, 0, width, height,
                             GL_ALPHA, GL_UNSIGNED_BYTE, stream->address());
+            break;
         case LUMINANCE:
-            glTexSubImage2D(target, level, 0, 0, size()[0], size()[1],
+            glTexSubImage2D(target, level, 0, 0, width, height,
                             GL_LUMINANCE, GL_UNSIGNED_BYTE, stream->address());
             break;
         case PVRTC4_RGBA:
-            glCompressedTexSubImage2D(target, level, 0, 0, size()[0], size()[1],
+            glCompressedTexSubImage2D(target, level, 0, 0, width, height,
                                       GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG,
                                       (GLsizei)stream->size(), stream->address());
+            break;
         case PVRTC2_RGBA:
-            glCompressedTexSubImage2D(target, level, 0, 0, size()[0], size()[1],
+            glCompressedTexSubImage2D(target, level, 0, 0, width, height,
                                       GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG,
                                       (GLsizei)stream->size(), stream->address());
             break;
         case PVRTC4_RGB:
-            glCompressedTexSubImage2D(target, level, 0, 0, size()[0], size()[1],
+            glCompressedTexSubImage2D(target, level, 0, 0, width, height,
                                       GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG,
                                       (GLsizei)stream->size(), stream->address());
             break;
         case PVRTC2_RGB:
-            glCompressedTexSubImage2D(target, level, 0, 0, size()[0], size()[1],
+            glCompressedTexSubImage2D(target, level, 0, 0, width, height,
                                       GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG,
                                       (GLsizei)stream->size(), stream->address());
             break;
@@ -3,6 +3,7 @@
 
 #include "re/gles20/gles2.h"
 #include "re/texture.h"
+#include <atomic>
 
 namespace gles20 {
     class gl_texture : public texture {
@@ -12,10 +13,25 @@ namespace gles20 {
         
         virtual bool load(memory_stream*, int color, int level = 0) override;
         virtual bool generate_mipmap() override;
+        virtual void swap(texture&) override;
         
         GLuint tex_id() const { return _tex_id; }
+        
+        // bumped whenever a texture is bound outside of the context,
+        // i.e. creating or uploading, which replaces the texture of
+        // the active unit
+        static uint32_t bind_generation() { return _bind_generation; }
+        
+        // bumped whenever a texture id is deleted or swapped to another
+        // texture, any unit could have it bound
+        static uint32_t id_generation() { return _id_generation; }
+        
     private:
+        void bind(GLenum target) const;
+        
         GLuint _tex_id;
+        static std::atomic<uint32_t> _bind_generation;
+        static std::atomic<uint32_t> _id_generation;
     };
 }
 
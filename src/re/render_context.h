@@ -20,34 +20,71 @@ public:
     render_context(size_t max_tex)
     : _textures(), _bound_textures()
     {
+        assert(max_tex <= sizeof(_dirty_textures) * 8);
         _textures.resize(max_tex);
         _bound_textures.resize(max_tex);
+        invalidate();
     }
     
     virtual render_context& set_current() = 0;
     virtual void apply() = 0;
-    virtual bool set_state(render_state const&) = 0;
     virtual bool set_program(gpu_program const&) = 0;
     virtual bool set_target(render_target const&) { return true; }; // FIXME
     
+    // the state will be applied at the next draw call, only
+    // the groups differing from the bound state will be issued
+    bool set_state(render_state const& state) {
+        _cur_state = state;
+        _dirty_state = _cur_state.diff(_bound_state) | _invalid_state;
+        return true;
+    }
+    
     void set_texture(int unit, texture* tex) {
         assert(unit < _textures.size());
-        if(tex)
-            _textures[unit] = tex->retain<texture>();
+        if(tex == nullptr || tex == _textures[unit].get())
+            return;
+        
+        _textures[unit] = tex->retain<texture>();
+        mark_texture(unit);
     }
     
     void clear_textures() {
-        for(auto& it : _textures)
-            it.reset();
+        int unit = 0;
+        for(auto& it : _textures) {
+            if(it) {
+                it.reset();
+                mark_texture(unit);
+            }
+            ++unit;
+        }
+    }
+    
+    // forget the shadowed states, i.e. the device state has been
+    // changed outside of the context, the next apply will issue all
+    void invalidate() {
+        _invalid_state = render_state::DirtyAll;
+        _dirty_state = render_state::DirtyAll;
+        _dirty_textures = _textures.empty() ? 0 : (~0u >> (sizeof(_dirty_textures) * 8 - _textures.size()));
     }
     
 protected:
     virtual ~render_context() {};
+    
+    void mark_texture(int unit) {
+        if(_textures[unit].get() == _bound_textures[unit].get()
+           && (_invalid_state == 0))
+            _dirty_textures &= ~(1u << unit);
+        else
+            _dirty_textures |= 1u << unit;
+    }
 
     render_state _cur_state;
     render_state _bound_state;
     textures_t _textures;
     textures_t _bound_textures;
+    uint32_t _dirty_state = 0;      // state groups to apply
+    uint32_t _invalid_state = 0;    // groups whose device state is unknown
+    uint32_t _dirty_textures = 0;   // texture units to bind
 };
 
 #endif
\ No newline at end of file
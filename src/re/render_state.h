@@ -28,6 +28,28 @@ public:
         BlendOneMinusDstAlpha, BlendOneMinusSrcAlpha,
         BlendMax,
     };
+
+    // blend equation
+    enum {
+        BlendAdd, BlendSubtract, BlendReverseSubtract,
+        BlendOpMax,
+    };
+
+    // face culling
+    enum {
+        CullNone, CullFront, CullBack, CullFrontAndBack,
+        CullMax,
+    };
+
+    // the groups of states that differ, see diff()
+    enum {
+        DirtyDepth = 1 << 0,
+        DirtyBlendFunc = 1 << 1,
+        DirtyBlendOp = 1 << 2,
+        DirtyBlendColor = 1 << 3,
+        DirtyCulling = 1 << 4,
+        DirtyAll = (1 << 5) - 1,
+    };
     
     typedef std::shared_ptr<render_state> ptr;
     typedef std::shared_ptr<render_state const> const_ptr;
@@ -66,6 +88,30 @@ public:
     bool operator == (render_state const& rhs) const {
         return memcmp(this, &rhs, sizeof(render_state)) == 0;
     }
+
+    // the bitmask of state groups that need to change from rhs to this
+    uint32_t diff(render_state const& rhs) const {
+        uint32_t mask = 0;
+        if (_depth_func != rhs._depth_func)
+            mask |= DirtyDepth;
+        if (_src_blend != rhs._src_blend || _dst_blend != rhs._dst_blend
+            || _src_alpha_blend != rhs._src_alpha_blend
+            || _dst_alpha_blend != rhs._dst_alpha_blend)
+            mask |= DirtyBlendFunc;
+        if (_blend_op != rhs._blend_op || _alpha_blend_op != rhs._alpha_blend_op)
+            mask |= DirtyBlendOp;
+        if (_blend_color != rhs._blend_color)
+            mask |= DirtyBlendColor;
+        if (_culling != rhs._culling)
+            mask |= DirtyCulling;
+        return mask;
+    }
+
+    // whether the blending is turned off
+    bool blend_disabled() const {
+        return _src_blend == BlendNone || _dst_blend == BlendNone
+            || _src_alpha_blend == BlendNone || _dst_alpha_blend == BlendNone;
+    }
     
     // viewport/scissor
 };
@@ -2,6 +2,7 @@
 #define _TEXTURE_H
 
 #include <memory>
+#include <utility>
 #include <Eigen/Dense>
 #include "common/referenced_count.h"
 
@@ -21,7 +22,8 @@ public:
     ///! color format
     enum {
         RGBA8888, RGB565, ALPHA, LUMINANCE,
-        PVRTC4_RGB, PVRTC2_RGB, PVRTC4_RGBA, PVRTC2_RGBA
+        PVRTC4_RGB, PVRTC2_RGB, PVRTC4_RGBA, PVRTC2_RGBA,
+        RGBA4444
     };
     
     ///! wrap
@@ -51,9 +53,22 @@ public:
     vector2i const& size() const { return _size; }
     attribute_t const& attribute() const { return _attribute; }
     
+    /// the estimated size in bytes of the first level
+    size_t memory_size() const {
+        static const size_t bits[] = { 32, 16, 8, 8, 4, 2, 4, 2, 16 };
+        return (size_t)_size.x() * _size.y() * bits[_attribute.color] / 8;
+    }
+    
     virtual bool load(memory_stream*, int color, int level = 0) = 0;
     virtual bool generate_mipmap() { return false; };
     
+    /// swap the content with the other one of the same device, i.e. the
+    /// reloaded one so the holders of this see the new data
+    virtual void swap(texture& other) {
+        std::swap(_size, other._size);
+        std::swap(_attribute, other._attribute);
+    }
+    
     constexpr static texture* null() { return nullptr; }
 private:
     vector2i _size;
@@ -12,6 +12,7 @@
 #include "com/action/action.h"
 #include "com/sprite2d/texture_atlas.h"
 #include "com/anim/animation.h"
+#include "com/render/camera.h"
 #include <vector>
 #include <array>
 
@@ -147,11 +148,88 @@ namespace script {
         return 1;
     }
 
+    // call the function after the delay, without any action
+    // returns the handle to cancel
+    static int c3d_lua_delay(lua_State* L) {
+        luaL_argcheck(L, lua_isnumber(L, 1), 1, "expect the delay");
+        luaL_argcheck(L, lua_isfunction(L, 2), 2, "expect a function");
+        if (!global_timer_base::has_created())
+            return luaL_error(L, "no global timer to delay, create one first");
+        
+        lua_pushvalue(L, 2);
+        std::shared_ptr<ref> func(new ref(L));
+        auto& wheel = global_timer_base::instance().wheel();
+        auto handle = wheel.schedule_after(lua_tonumber(L, 1), [func] () {
+            lua_State* L = func->parent()->internal();
+            func->push(L);
+            if (lua_pcall(L, 0, 0, 0) != 0) {
+                LOG_WARN(action, "running delayed script errors: \n"
+                         << lua_tostring(L, -1));
+                lua_pop(L, 1);
+            }
+        });
+        lua_pushnumber(L, (lua_Number)handle);
+        return 1;
+    }
+    
+    static int c3d_lua_cancel_delay(lua_State* L) {
+        if (!global_timer_base::has_created())
+            return luaL_error(L, "no global timer to cancel the delay");
+        
+        auto handle = (timer_wheel::handle_t)lua_tonumber(L, 1);
+        lua_pushboolean(L, global_timer_base::instance().wheel().cancel(handle));
+        return 1;
+    }
+
+    static int c3d_lua_skeleton_load(lua_State* L) {
+        data_stream& ds = converter<data_stream&>::from(L, 1, nullptr);
+        std::vector<texture_atlas*> atlases;
+        if (lua_gettop(L) >= 2)
+            atlases = converter<std::vector<texture_atlas*>>::from(L, 2, nullptr);
+        
+        // the clips are compressed by the tolerances if given:
+        // translate, scale, rotate
+        com::skeleton::compression compression;
+        bool compressed = lua_gettop(L) >= 3;
+        if (compressed) {
+            compression.translate = (float)luaL_optnumber(L, 3, compression.translate);
+            compression.scale = (float)luaL_optnumber(L, 4, compression.scale);
+            compression.rotate = (float)luaL_optnumber(L, 5, compression.rotate);
+        }
+        
+        auto skel = com::skeleton::load_from(&ds, atlases, compressed ? &compression : nullptr);
+        converter<decltype(skel)>::to(L, std::move(skel));
+        return 1;
+    }
+
+    // the camera lod policy: camera, distance, rate, [margin];
+    // no camera to update all the animations every frame
+    static int c3d_lua_set_camera_lod(lua_State* L) {
+        auto& mgr = converter<com::animation_mgr&>::from(L, 1, nullptr);
+        if (lua_isnoneornil(L, 2)) {
+            mgr.set_lod_policy(nullptr);
+        } else {
+            auto* cam = converter<com::camera*>::from(L, 2, nullptr);
+            float distance = (float)luaL_checknumber(L, 3);
+            uint32_t rate = (uint32_t)luaL_checkinteger(L, 4);
+            float margin = (float)luaL_optnumber(L, 5, .2f);
+            mgr.set_lod_policy(com::animation_mgr::camera_lod(cam, distance, rate, margin));
+        }
+        lua_settop(L, 1);
+        return 1;
+    }
+
     void def_action(state* st, std::string const& scope) {
         st->import((scope + ".action").c_str())
         .def("from", &c3d_lua_make_script_action)
         .def("wait_time", &c3d_lua_make_timer_action)
         .def("wait_frame", &c3d_lua_make_frame_action)
+        .def("delay", &c3d_lua_delay)
+        .def("cancel_delay", &c3d_lua_cancel_delay)
+        ;
+        
+        st->import(scope.c_str())
+        .def("load_skeleton", &c3d_lua_skeleton_load)
         ;
 
         script::class_<action>::type()
@@ -168,13 +246,27 @@ namespace script {
         .def("add_group", LUA_BIND(&com::action::add_group))
         ;
         
+        script::class_<com::skeleton>::type()
+        .def("save_binary", LUA_BIND_S(bool (com::skeleton::*)(std::string const&) const,
+                                       &com::skeleton::save_binary))
+        ;
+        
         script::class_<com::animation>::type()
         .def("play", LUA_BIND(&com::animation::play))
+        .def("crossfade", LUA_BIND(&com::animation::crossfade))
+        .def("play_layer", LUA_BIND(&com::animation::play_layer))
+        .def("set_layer_weight", LUA_BIND(&com::animation::set_layer_weight))
+        .def("set_layer_mask", LUA_BIND(&com::animation::set_layer_mask))
+        .def("set_active", LUA_BIND(&com::animation::set_active))
         .def("make_action", LUA_BIND(&com::animation::make_action))
         .def("set_index", LUA_BIND_S(com::animation& (com::animation::*)(int32_t const&),
                                      &com::animation::set_start_index))
         ;
         
+        script::class_<com::animation_mgr>::type()
+        .def("set_camera_lod", &c3d_lua_set_camera_lod)
+        ;
+        
         script::class_<game_object>::type()
         .def("add_action", LUA_BIND(&game_object::add_component<com::action>))
         .def("make_translate_action", LUA_BIND(&c3d_go_make_translate_action))
@@ -186,6 +278,8 @@ namespace script {
         .def("add_animation",
              LUA_BIND((&game_object::add_component<com::animation,
                        data_stream*, std::vector<texture_atlas*> const&, int32_t>)))
+        .def("add_skeleton_animation",
+             LUA_BIND((&game_object::add_component<com::animation, com::skeleton const*, int32_t>)))
         ;
     }
 }
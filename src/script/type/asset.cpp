@@ -13,15 +13,35 @@ namespace script {
         class_<asset_collection>::type()
         .def("load_texture", LUA_BIND(&asset_collection::load<texture>))
         .def("contains", LUA_BIND(&asset_collection::contains))
+        .def("load_async", LUA_BIND(&asset_collection::load_async))
+        .def("wait", LUA_BIND(&asset_collection::wait))
+        .def("add_dependency", LUA_BIND(&asset_collection::add_dependency))
+        .def("preload", LUA_BIND(&asset_collection::preload))
+        .def("set_budget", LUA_BIND(&asset_collection::set_budget))
+        .def("purge", LUA_BIND(&asset_collection::purge))
+        ;
+
+        class_<asset_request>::type()
+        .def("ready", LUA_BIND(&asset_request::ready))
+        .def("cancel", LUA_BIND(&asset_request::cancel))
+        .def("get_texture", LUA_BIND(&asset_request::get<texture>))
+        ;
+
+        class_<asset_preload>::type()
+        .def("progress", LUA_BIND(&asset_preload::progress))
+        .def("done", LUA_BIND(&asset_preload::done))
+        .def("cancel", LUA_BIND(&asset_preload::cancel))
         ;
 
         class_<asset_manager>::type()
         .derive<asset_collection>()
+        .def("reload_changes", LUA_BIND(&asset_manager::reload_changes))
         ;
         
         class_<locator_mgr>::type()
         .def("from", LUA_BIND(&locator_mgr::from))
         .def("add_locator", LUA_BIND(&locator_mgr::add_locator))
+        .def("invalidate", LUA_BIND(&locator_mgr::invalidate))
         ;
     }
 }
@@ -14,5 +14,6 @@ namespace script {
     void def_game_object(state*, std::string const& = "");      // game_object/transform
     void def_render_device(state*, std::string const& = "");    // render_device/gpu_program/etc..
     void def_sprite2d(state*, std::string const& = "");         // sprite_mgr/quad_sprite
+    void def_particle(state*, std::string const& = "");         // particle_system/random_stream
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "script/state.h"
+#include "script/type/def.h"
+#include "script/class_type.h"
+#include "script/lua_bind.h"
+#include "script/type/convert.h"
+
+#include "go/game_object.h"
+#include "com/particle/particle_system.h"
+#include "com/particle/particle_sprite.h"
+#include "com/sprite2d/texture_atlas.h"
+#include "common/random.h"
+
+namespace script {
+    // a seeded stream for the scripts, math.random is global
+    static int c3d_lua_random_stream(lua_State* L) {
+        typedef std::unique_ptr<random_stream> ptr;
+        converter<ptr>::to(L, ptr(new random_stream((uint64_t)luaL_optnumber(L, 1, 0))));
+        return 1;
+    }
+
+    // the same as math.random: [0, 1), [1, m] or [m, n]
+    static int c3d_lua_random_next(lua_State* L) {
+        random_stream& rs = converter<random_stream&>::from(L, 1, nullptr);
+        switch (lua_gettop(L)) {
+            case 1:
+                lua_pushnumber(L, rs.next_float());
+                break;
+            case 2: {
+                int upper = luaL_checkint(L, 2);
+                luaL_argcheck(L, 1 <= upper, 2, "interval is empty");
+                lua_pushinteger(L, rs.uniform_int(1, upper));
+                break;
+            }
+            default: {
+                int lower = luaL_checkint(L, 2), upper = luaL_checkint(L, 3);
+                luaL_argcheck(L, lower <= upper, 3, "interval is empty");
+                lua_pushinteger(L, rs.uniform_int(lower, upper));
+                break;
+            }
+        }
+        return 1;
+    }
+
+    static int c3d_lua_random_seed(lua_State* L) {
+        random_stream& rs = converter<random_stream&>::from(L, 1, nullptr);
+        rs.set_seed((uint64_t)luaL_optnumber(L, 2, 0));
+        return 0;
+    }
+
+    void def_particle(state* st, std::string const& scope) {
+        typedef com::particle_system ps_t;
+        typedef com::particle_sprite pspt_t;
+
+        script::class_<ps_t>::type()
+        .def("emit", LUA_BIND(&ps_t::emit))
+        .def("clear", LUA_BIND(&ps_t::clear))
+        .def("set_capacity", LUA_BIND(&ps_t::set_capacity))
+        .def("set_rate", LUA_BIND_S(ps_t& (ps_t::*)(float const&), &ps_t::set_rate))
+        .def("set_active", LUA_BIND_S(ps_t& (ps_t::*)(bool const&), &ps_t::set_active))
+        .def("set_life", LUA_BIND(&ps_t::set_life))
+        .def("set_color", LUA_BIND(&ps_t::set_color))
+        .def("set_size", LUA_BIND(&ps_t::set_size))
+        .def("set_force", LUA_BIND(&ps_t::set_force))
+        .def("set_emitter", LUA_BIND(&ps_t::set_emitter))
+        .def("set_seed", LUA_BIND(&ps_t::set_seed))
+        ;
+
+        script::class_<pspt_t>::type()
+        .derive<sprite2d::sprite>()
+        .def("set_from_atlas", LUA_BIND(&pspt_t::set_from_atlas))
+        ;
+
+        script::class_<random_stream>::type()
+        .def("random", &c3d_lua_random_next)
+        .def("seed", &c3d_lua_random_seed)
+        ;
+
+        st->import(scope.c_str())
+        .def("random_stream", &c3d_lua_random_stream)
+        ;
+
+        script::class_<game_object>::type()
+        .def("add_particles", LUA_BIND((&game_object::add_component<ps_t, uint32_t>)))
+        .def("add_particle_sprite", LUA_BIND((&game_object::add_component<
+                                              pspt_t, texture_atlas const&, std::string const&,
+                                              std::string const&>)))
+        ;
+    }
+}